@@ -0,0 +1,998 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "bench.hpp"
+#include "rfc2822/address.hpp"
+#include "rfc2822/address-interned.hpp"
+#include "rfc2822/address-list.hpp"
+#include "rfc2822/address-ref.hpp"
+#include "rfc2822/address-view.hpp"
+#include "rfc2822/date.hpp"
+#include "rfc2822/header.hpp"
+#include "rfc2822/mbox.hpp"
+#include "rfc2822/parse.hpp"
+#include "rfc2822/profile.hpp"
+#include "rfc2822/recognize.hpp"
+#include "rfc2822/skipper.hpp"
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <boost/unordered_map.hpp>
+
+using namespace std;
+using namespace rfc2822;
+
+// Count every heap allocation made by the process.
+
+unsigned long bench::allocations = 0;
+bool bench::count_allocations = true;
+
+void * operator new(size_t n)
+{
+  if (bench::count_allocations) ++bench::allocations;
+  if (void * p = malloc(n ? n : 1)) return p;
+  throw bad_alloc();
+}
+
+void * operator new[](size_t n)
+{
+  if (bench::count_allocations) ++bench::allocations;
+  if (void * p = malloc(n ? n : 1)) return p;
+  throw bad_alloc();
+}
+
+void operator delete(void * p) throw()          { free(p); }
+void operator delete[](void * p) throw()        { free(p); }
+void operator delete(void * p, size_t) throw()   { free(p); }
+void operator delete[](void * p, size_t) throw() { free(p); }
+
+// The parsers under test. Each one extracts its result the way a regular
+// client would, so that the cost of the semantic actions is included.
+
+static char const * parse_addr_spec(char const * first, char const * last)
+{
+  string result;
+  spirit::parse_info<> const r = parse(first, last, addr_spec_p [spirit::assign_a(result)], skipper_p);
+  return r.hit ? r.stop : NULL;
+}
+
+static char const * parse_mailbox(char const * first, char const * last)
+{
+  string result;
+  spirit::parse_info<> const r = parse(first, last, mailbox_p [spirit::assign_a(result)], skipper_p);
+  return r.hit ? r.stop : NULL;
+}
+
+static char const * parse_addr_spec_view(char const * first, char const * last)
+{
+  mailbox_view<> result;
+  spirit::parse_info<> const r = parse(first, last, addr_spec_view_p [spirit::assign_a(result)], skipper_p);
+  return r.hit ? r.stop : NULL;
+}
+
+static char const * parse_mailbox_view(char const * first, char const * last)
+{
+  mailbox_view<> result;
+  spirit::parse_info<> const r = parse(first, last, mailbox_view_p [spirit::assign_a(result)], skipper_p);
+  return r.hit ? r.stop : NULL;
+}
+
+static char const * parse_addr_spec_ref(char const * first, char const * last)
+{
+  canonic_string result;
+  spirit::parse_info<> const r = parse(first, last, addr_spec_ref_p [spirit::assign_a(result)], skipper_p);
+  return r.hit ? r.stop : NULL;
+}
+
+static char const * parse_mailbox_ref(char const * first, char const * last)
+{
+  canonic_string result;
+  spirit::parse_info<> const r = parse(first, last, mailbox_ref_p [spirit::assign_a(result)], skipper_p);
+  return r.hit ? r.stop : NULL;
+}
+
+// What a mail router does with an address: find its domain, in lower
+// case, in a table. The first variant does it to the result of domain_p,
+// the second lets the parser intern the domain as it goes.
+
+static boost::unordered_map<string, domain_id> route_map;
+static domain_table                             route_table;
+
+static char const * route_by_string(char const * first, char const * last)
+{
+  string domain;
+  spirit::parse_info<> const r = parse( first, last
+                                      , spirit::no_actions_d[local_part_p] >> '@' >> domain_p [spirit::assign_a(domain)]
+                                      , skipper_p
+                                      );
+  if (!r.hit) return NULL;
+  for (string::iterator i = domain.begin(); i != domain.end(); ++i) *i = tolower(*i);
+  if (route_map.find(domain) == route_map.end())
+    route_map[domain] = static_cast<domain_id>(route_map.size() + 1u);
+  return r.stop;
+}
+
+static char const * route_interned(char const * first, char const * last)
+{
+  interned_addr_spec result;
+  spirit::parse_info<> const r = parse(first, last, interned_addr_spec_p(route_table) [spirit::assign_a(result)], skipper_p);
+  return r.hit ? r.stop : NULL;
+}
+
+// The address parsers instantiated for arena_string, with one arena per
+// parse -- as one would have one per message.
+
+static basic_addr_spec_parser<arena_string> const addr_spec_arena_p;
+static basic_mailbox_parser<arena_string> const   mailbox_arena_p;
+
+static char const * parse_addr_spec_arena(char const * first, char const * last)
+{
+  char buffer[1024];
+  arena pool(buffer, sizeof(buffer));
+  arena::scope const scope(pool);
+  arena_string result;
+  spirit::parse_info<> const r = parse(first, last, addr_spec_arena_p [spirit::assign_a(result)], skipper_p);
+  return r.hit ? r.stop : NULL;
+}
+
+static char const * parse_mailbox_arena(char const * first, char const * last)
+{
+  char buffer[1024];
+  arena pool(buffer, sizeof(buffer));
+  arena::scope const scope(pool);
+  arena_string result;
+  spirit::parse_info<> const r = parse(first, last, mailbox_arena_p [spirit::assign_a(result)], skipper_p);
+  return r.hit ? r.stop : NULL;
+}
+
+struct count_mailboxes
+{
+  size_t * n;
+  explicit count_mailboxes(size_t & i) : n(&i) { }
+  void operator() (mailbox_view<> const &) const { ++*n; }
+};
+
+static char const * visit_address_list(char const * first, char const * last)
+{
+  size_t n( 0u );
+  spirit::parse_info<> const r = parse(first, last, address_list_p(count_mailboxes(n)), skipper_p);
+  return r.hit ? r.stop : NULL;
+}
+
+// A whole address list per input, once on one thread and once split
+// across all CPUs. Unless the library was built with --enable-threads,
+// both use one thread.
+
+static char const * parse_address_list_threads(char const * first, char const * last, unsigned threads)
+{
+  static vector<string> result;
+  result.clear();
+  address_list_options opt;
+  opt.threads = threads;
+  return parse_address_list(first, last, result, opt) ? last : NULL;
+}
+
+static char const * parse_address_list_single(char const * first, char const * last)
+{
+  return parse_address_list_threads(first, last, 1u);
+}
+
+static char const * parse_address_list_all(char const * first, char const * last)
+{
+  return parse_address_list_threads(first, last, 0u);
+}
+
+static char const * parse_route_addr(char const * first, char const * last)
+{
+  string result;
+  spirit::parse_info<> const r = parse(first, last, route_addr_p [spirit::assign_a(result)], skipper_p);
+  return r.hit ? r.stop : NULL;
+}
+
+static char const * parse_date(char const * first, char const * last)
+{
+  timestamp tstamp;
+  spirit::parse_info<> const r = parse(first, last, date_p [spirit::assign_a(tstamp)], skipper_p);
+  return r.hit ? r.stop : NULL;
+}
+
+static char const * parse_date_mktime(char const * first, char const * last)
+{
+  timestamp tstamp;
+  spirit::parse_info<> const r = parse(first, last, date_p [spirit::assign_a(tstamp)], skipper_p);
+  return r.hit && mktime(&tstamp) != time_t(-1) ? r.stop : NULL;
+}
+
+static char const * parse_date_epoch(char const * first, char const * last)
+{
+  timestamp tstamp;
+  spirit::parse_info<> const r = parse(first, last, date_p [spirit::assign_a(tstamp)], skipper_p);
+  volatile boost::int64_t const t( r.hit ? epoch_seconds(tstamp) : 0 );
+  (void)t;
+  return r.hit ? r.stop : NULL;
+}
+
+// The same parsers called through the precompiled functions of
+// rfc2822/parse.hpp.
+
+static char const * precompiled_addr_spec(char const * first, char const * last)
+{
+  string result;
+  return rfc2822::parse_addr_spec(first, last, result);
+}
+
+static char const * precompiled_mailbox(char const * first, char const * last)
+{
+  string result;
+  return rfc2822::parse_mailbox(first, last, result);
+}
+
+static char const * precompiled_date(char const * first, char const * last)
+{
+  timestamp tstamp;
+  return rfc2822::parse_date(first, last, tstamp);
+}
+
+static char const * parse_header(char const * first, char const * last)
+{
+  static vector<header_field> fields;
+  fields.clear();
+  header_info const r( split_header(first, last, fields) );
+  return r.status == header_complete ? r.stop : NULL;
+}
+
+// Headers as they come in from the network, in chunks of 64 bytes: once
+// fed to a header_stream, and once split from the start after every chunk.
+
+static size_t const chunk_size = 64;
+
+static char const * parse_header_stream(char const * first, char const * last)
+{
+  static header_stream s;
+  static vector<header_field> fields;
+  s.reset();
+  for (char const * p = first; p != last; p += min<size_t>(chunk_size, last - p))
+  {
+    fields.clear();
+    header_info const r( s.feed(p, p + min<size_t>(chunk_size, last - p), fields) );
+    if (r.status == header_complete) return r.stop;
+    if (r.status == header_malformed) return NULL;
+  }
+  return s.finish(fields) == header_complete ? last : NULL;
+}
+
+static char const * parse_header_resplit(char const * first, char const * last)
+{
+  static vector<header_field> fields;
+  for (char const * p = first; p != last; p += min<size_t>(chunk_size, last - p))
+  {
+    fields.clear();
+    bool const at_eof( last - p <= static_cast<ptrdiff_t>(chunk_size) );
+    header_info const r( split_header(first, p + min<size_t>(chunk_size, last - p), fields, at_eof) );
+    if (r.status == header_complete) return r.stop;
+    if (r.status == header_malformed) return NULL;
+  }
+  return NULL;
+}
+
+// A whole mbox per input, once on one thread and once on all CPUs. Unless
+// the library was built with --enable-threads, both use one thread.
+
+static void ignore_message(mbox_message const &) { }
+
+static char const * parse_mbox_threads(char const * first, char const * last, unsigned threads)
+{
+  mbox_options opt;
+  opt.threads = threads;
+  return parse_mbox(first, last, &ignore_message, opt) ? last : NULL;
+}
+
+static char const * parse_mbox_single(char const * first, char const * last)
+{
+  return parse_mbox_threads(first, last, 1u);
+}
+
+static char const * parse_mbox_all(char const * first, char const * last)
+{
+  return parse_mbox_threads(first, last, 0u);
+}
+
+static char const * parse_month(char const * first, char const * last)
+{
+  int month;
+  spirit::parse_info<> const r = parse(first, last, spirit::nocase_d[ month_p [spirit::assign_a(month)] ]);
+  return r.hit ? r.stop : NULL;
+}
+
+static char const * parse_timezone(char const * first, char const * last)
+{
+  int offset;
+  spirit::parse_info<> const r = parse(first, last, spirit::nocase_d[ timezone_p [spirit::assign_a(offset)] ]);
+  return r.hit ? r.stop : NULL;
+}
+
+static char const * parse_atom(char const * first, char const * last)
+{
+  spirit::parse_info<> const r = parse(first, last, atom_p);
+  return r.hit ? r.stop : NULL;
+}
+
+static char const * parse_comment(char const * first, char const * last)
+{
+  spirit::parse_info<> const r = parse(first, last, comment_p);
+  return r.hit ? r.stop : NULL;
+}
+
+static char const * parse_lwsp(char const * first, char const * last)
+{
+  spirit::parse_info<> const r = parse(first, last, lwsp_p);
+  return r.hit ? r.stop : NULL;
+}
+
+static char const * parse_quoted_string(char const * first, char const * last)
+{
+  spirit::parse_info<> const r = parse(first, last, quoted_string_p);
+  return r.hit ? r.stop : NULL;
+}
+
+static char const * parse_skipper(char const * first, char const * last)
+{
+  spirit::parse_info<> const r = parse(first, last, *skipper_p);
+  return r.hit ? r.stop : NULL;
+}
+
+// Deterministic pseudo-random corpus generation.
+
+struct generator
+{
+  unsigned long state;
+
+  explicit generator(unsigned long seed) : state(seed) { }
+
+  unsigned long operator()(unsigned long n)
+  {
+    state = state * 1103515245u + 12345u;
+    return ((state >> 16) & 0x7fff) % n;
+  }
+
+  bool chance(unsigned percent) { return (*this)(100) < percent; }
+
+  template <size_t N>
+  char const * pick(char const * const (&words)[N]) { return words[(*this)(N)]; }
+
+  string atom(size_t min_len, size_t max_len)
+  {
+    static char const atext[] = "abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz-_+=!#$%&'*/?^`{|}~";
+    size_t const len = min_len + (*this)(max_len - min_len + 1);
+    string s;
+    for (size_t i = 0; i != len; ++i) s += atext[(*this)(sizeof(atext) - 1)];
+    return s;
+  }
+
+  string dot_atom(size_t parts)
+  {
+    string s = atom(2, 10);
+    for (size_t i = 1; i < parts; ++i) s += '.' + atom(2, 10);
+    return s;
+  }
+
+  string cfws()
+  {
+    switch ((*this)(4))
+    {
+      case 0:  return " ";
+      case 1:  return "\r\n\t";
+      case 2:  return " (" + atom(3, 12) + ") ";
+      default: return "";
+    }
+  }
+
+  string domain()
+  {
+    static char const * const tlds[] = { "org", "com", "net", "de", "to", "co.uk" };
+    if (chance(2))
+      return "[192.168." + to_str((*this)(256)) + "." + to_str((*this)(256)) + "]";
+    return dot_atom(1 + (*this)(3)) + "." + pick(tlds);
+  }
+
+  string quoted(size_t max_len)
+  {
+    string s = "\"";
+    size_t const len = 1 + (*this)(max_len);
+    for (size_t i = 0; i != len; ++i)
+    {
+      if (chance(3))        s += "\\\"";
+      else if (chance(10))  s += ' ';
+      else                  s += atom(1, 1);
+    }
+    return s + "\"";
+  }
+
+  string plain_addr_spec() { return dot_atom(1 + (*this)(2)) + "@" + domain(); }
+
+  string messy_addr_spec()
+  {
+    string s = chance(10) ? quoted(16) : atom(2, 10);
+    for (size_t n = (*this)(3); n; --n) s += cfws() + "." + cfws() + atom(2, 10);
+    return s + cfws() + "@" + cfws() + domain() + cfws();
+  }
+
+  /// An address at one of a few dozen domains, spelled in varying case.
+  string routed_addr_spec()
+  {
+    generator pool(42);
+    string d;
+    for (size_t n = 1 + (*this)(50); n; --n) d = pool.dot_atom(1 + pool(2)) + ".com";
+    for (string::iterator i = d.begin(); i != d.end(); ++i)
+      if (chance(10)) *i = toupper(*i);
+    return dot_atom(1 + (*this)(2)) + "@" + d;
+  }
+
+  /// What spam brings: binary junk, addresses without "@", control
+  /// characters, and comments or quoted strings that never end.
+  string garbage_addr_spec()
+  {
+    switch ((*this)(5))
+    {
+      case 0:
+      {
+        string s;
+        for (size_t n = 8 + (*this)(32); n; --n) s += static_cast<char>((*this)(256));
+        return s;
+      }
+      case 1:  return dot_atom(1 + (*this)(2)) + "." + domain();
+      case 2:  return atom(2, 10) + static_cast<char>(1 + (*this)(31)) + atom(2, 10) + "@" + domain();
+      case 3:  return atom(2, 10) + " (" + atom(2, 10) + "@" + domain();
+      default: return "\"" + atom(2, 10) + "@" + domain();
+    }
+  }
+
+  string display_name()
+  {
+    static char const * const names[] = { "Peter", "Simons", "Dr.", "Foo", "Bar", "John", "Q.", "Public" };
+    if (chance(20)) return quoted(24);
+    string s = pick(names);
+    for (size_t n = (*this)(3); n; --n) s += string(" ") + pick(names);
+    return s;
+  }
+
+  string route()
+  {
+    string s = "@" + domain();
+    for (size_t n = (*this)(2); n; --n) s += ",@" + domain();
+    return s + ":";
+  }
+
+  string mailbox()
+  {
+    switch ((*this)(4))
+    {
+      case 0:  return plain_addr_spec();
+      case 1:  return plain_addr_spec() + " (" + display_name() + ")";
+      case 2:  return "<" + plain_addr_spec() + ">";
+      default: return display_name() + " <" + (chance(5) ? route() : string()) + plain_addr_spec() + ">";
+    }
+  }
+
+  string address_list(size_t max_len)
+  {
+    string s = mailbox();
+    for (size_t n = (*this)(max_len); n; --n)
+    {
+      s += chance(20) ? ",\r\n " : ", ";
+      if (chance(5))
+      {
+        s += display_name() + ": " + mailbox();
+        for (size_t m = (*this)(4); m; --m) s += ", " + mailbox();
+        s += ";";
+      }
+      else
+        s += mailbox();
+    }
+    return s;
+  }
+
+  string date(bool canonical)
+  {
+    static char const * const wdays[]  = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+    static char const * const months[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                           "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+    static char const * const zones[]  = { "GMT", "UT", "EST", "EDT", "CST", "PDT", "Z" };
+    char buf[128];
+    unsigned const zone = (*this)(1200);
+    if (canonical)
+      snprintf(buf, sizeof(buf), "%s, %02lu %s %lu %02lu:%02lu:%02lu %c%04u",
+               pick(wdays), 1 + (*this)(28), pick(months), 1970 + (*this)(60),
+               (*this)(24), (*this)(60), (*this)(60),
+               chance(50) ? '+' : '-', (zone / 60) * 100 + zone % 60);
+    else
+      snprintf(buf, sizeof(buf), "%s%lu %s %lu %02lu:%02lu%s %s%s",
+               chance(50) ? "" : "Thu,  ", 1 + (*this)(28), pick(months),
+               chance(20) ? 70 + (*this)(30) : 1970 + (*this)(60),
+               (*this)(24), (*this)(60), chance(50) ? ":00" : "",
+               pick(zones), chance(20) ? " (CEST)" : "");
+    return buf;
+  }
+
+  string keyword(char const * const * names, size_t n)
+  {
+    string s = names[(*this)(n)];
+    for (size_t i = 0; i != s.size(); ++i)
+      if (chance(30)) s[i] = toupper(s[i]);
+    return s;
+  }
+
+  string month()
+  {
+    static char const * const months[] = { "jan", "feb", "mar", "apr", "may", "jun",
+                                           "jul", "aug", "sep", "oct", "nov", "dec" };
+    return keyword(months, 12);
+  }
+
+  string zone()
+  {
+    static char const * const zones[] = { "ut", "gmt", "est", "edt", "cst", "cdt", "mst",
+                                          "mdt", "pst", "pdt", "z", "a", "m", "n", "y" };
+    return keyword(zones, 15);
+  }
+
+  string comment(size_t depth)
+  {
+    string s = "(";
+    for (size_t n = 1 + (*this)(6); n; --n)
+    {
+      if (depth && chance(15))  s += comment(depth - 1);
+      else if (chance(5))       s += "\\)";
+      else if (chance(5))       s += "\r\n\t";
+      else                      s += atom(1, 12) + " ";
+    }
+    return s + ")";
+  }
+
+  string received_comment()
+  {
+    return "(from " + domain() + " [" + to_str((*this)(256)) + "." + to_str((*this)(256)) + ".0.1]"
+           " by " + domain() + " (Postfix) with ESMTPS id " + atom(10, 12) +
+           " for <" + plain_addr_spec() + ">; (envelope-from " + plain_addr_spec() + "))";
+  }
+
+  string lwsp()
+  {
+    string s;
+    for (size_t n = 1 + (*this)(4); n; --n)
+      s += (chance(30) ? "\r\n" : "") + string(1 + (*this)(8), chance(50) ? ' ' : '\t');
+    return s;
+  }
+
+  string header()
+  {
+    string s;
+    for (size_t n = 1 + (*this)(4); n; --n)
+      s += "Received: " + received_comment() + "\r\n\t; " + date(true) + "\r\n";
+    s += "Date: " + date(chance(80)) + "\r\n";
+    s += "From: " + mailbox() + "\r\n";
+    s += "To: " + mailbox();
+    for (size_t n = (*this)(4); n; --n) s += ",\r\n " + mailbox();
+    s += "\r\nMessage-ID: <" + atom(16, 24) + "@" + domain() + ">\r\n";
+    s += "Subject: " + display_name() + "\r\n";
+    return s + "\r\n";
+  }
+
+  static string to_str(unsigned long n)
+  {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%lu", n);
+    return buf;
+  }
+};
+
+static bench::corpus generate(char const * name, string (*f)(generator &), size_t n = 2000)
+{
+  bench::corpus c;
+  c.name = name;
+  generator g(4711);
+  for (size_t i = 0; i != n; ++i) c.inputs.push_back(f(g));
+  return c;
+}
+
+static string gen_plain_addr(generator & g)     { return g.plain_addr_spec(); }
+static string gen_messy_addr(generator & g)     { return g.messy_addr_spec(); }
+static string gen_garbage_addr(generator & g)   { return g.garbage_addr_spec(); }
+static string gen_routed_addr(generator & g)    { return g.routed_addr_spec(); }
+static string gen_mailbox(generator & g)        { return g.mailbox(); }
+static string gen_address_list(generator & g) { return g.address_list(200); }
+static string gen_huge_list(generator & g)    { return g.address_list(50000); }
+static string gen_route_addr(generator & g)     { return "<" + g.route() + g.plain_addr_spec() + ">"; }
+static string gen_canonical_date(generator & g) { return g.date(true); }
+static string gen_other_date(generator & g)     { return g.date(false); }
+static string gen_month(generator & g)          { return g.month(); }
+static string gen_zone(generator & g)           { return g.zone(); }
+static string gen_atom(generator & g)           { return g.atom(1, 64); }
+static string gen_comment(generator & g)        { return g.chance(50) ? g.comment(3) : g.received_comment(); }
+static string gen_lwsp(generator & g)           { return g.lwsp(); }
+static string gen_quoted_string(generator & g)  { return g.quoted(64); }
+static string gen_skipper(generator & g)        { return g.chance(50) ? g.lwsp() : g.lwsp() + g.comment(2) + g.lwsp(); }
+static string gen_header(generator & g)         { return g.header(); }
+
+static string gen_mbox(generator & g)
+{
+  string s;
+  for (size_t n = 0; n != 2000; ++n)
+  {
+    string const header = g.header();
+    s += "From " + g.plain_addr_spec() + " Thu Sep  4 14:12:17 1973\n";
+    for (size_t i = 0; i != header.size(); ++i)
+      if (header[i] != '\r') s += header[i];
+    for (size_t lines = g(20); lines; --lines) s += g.atom(10, 70) + "\n";
+  }
+  return s;
+}
+
+// The folded and commented inputs of test/address.cpp.
+
+static char const * const address_tests[] =
+  { "peter\r\n . \r\n simons @ (Peter) cryp.to"
+  , "peter\r\n . \r\n simons @ [127\r\n  .0\r\n\t.0.1]"
+  , "normal . address @ example\r\n\t.org"
+  , "< normal . address @ example\r\n\t.org >"
+  , " Peter Simons < normal . address @ example\r\n\t.org >"
+  , " Dr. Foo Bar < foo . bar @ example\r\n\t.org >"
+  , "normal . address @ example\r\n\t.org (Peter Simnos)"
+  , "Dies \"ist \\\" > ein\" Test <@yahoo.org,@hugelwurz.cys.de:\"normal . address \"@ example\r\n\t.org >"
+  };
+
+static bench::corpus from_array(char const * name, char const * const * first, char const * const * last)
+{
+  bench::corpus c;
+  c.name = name;
+  c.inputs.assign(first, last);
+  return c;
+}
+
+// Recorded corpora are plain message headers. Lines may end in LF or CRLF,
+// continuation lines are folded back into the preceding field, and the
+// field name decides which corpus the value goes into. Every header block,
+// up to an empty line, also goes into the header corpus with CRLF line ends.
+
+struct recorded
+{
+  bench::corpus date, mailbox, address_list, route_addr, header;
+};
+
+static bool field_is(string const & name, char const * what)
+{
+  return name.size() == strlen(what) && strncasecmp(name.data(), what, name.size()) == 0;
+}
+
+static void add_field(recorded & rec, string const & name, string const & value)
+{
+  if (field_is(name, "Date") || field_is(name, "Resent-Date"))
+    rec.date.inputs.push_back(value);
+  else if (field_is(name, "From") || field_is(name, "Sender") || field_is(name, "Reply-To")
+           || field_is(name, "Resent-From") || field_is(name, "Resent-Sender"))
+    rec.mailbox.inputs.push_back(value);
+  else if (field_is(name, "To") || field_is(name, "Cc") || field_is(name, "Bcc")
+           || field_is(name, "Resent-To") || field_is(name, "Resent-Cc"))
+    rec.address_list.inputs.push_back(value);
+  else if (field_is(name, "Return-Path"))
+    rec.route_addr.inputs.push_back(value);
+}
+
+static void load_headers(recorded & rec, char const * path)
+{
+  ifstream is(path, ios::binary);
+  if (!is)
+  {
+    cerr << "cannot open " << path << endl;
+    exit(1);
+  }
+  string line, name, value, block;
+  bool have_field = false;
+  while (getline(is, line))
+  {
+    if (!line.empty() && line[line.size() - 1] == '\r')
+      line.erase(line.size() - 1);
+    block += line + "\r\n";
+    if (line.empty())
+    {
+      if (block.size() > 2) rec.header.inputs.push_back(block);
+      block.clear();
+    }
+    if (!line.empty() && (line[0] == ' ' || line[0] == '\t'))
+    {
+      if (have_field) value += "\r\n" + line;
+      continue;
+    }
+    if (have_field) add_field(rec, name, value);
+    have_field = false;
+    string::size_type const colon = line.find(':');
+    if (colon == string::npos || colon == 0) continue;
+    name  = line.substr(0, colon);
+    value = line.substr(colon + 1);
+    have_field = true;
+  }
+  if (have_field) add_field(rec, name, value);
+  if (!block.empty()) rec.header.inputs.push_back(block + "\r\n");
+}
+
+// Cold start: the first parse of each kind builds the grammar definitions
+// it needs. Every measurement runs in a child process of its own, which
+// starts out just as cold as the benchmark itself, and reports back
+// through shared memory.
+
+struct startup_case
+{
+  char const *          name;
+  bench::parse_function parse;
+  char const *          input;
+};
+
+static startup_case const startup_cases[] =
+  { { "addr_spec_p",       parse_addr_spec,     "peter . simons @ (Peter) cryp.to" }
+  , { "mailbox_p",         parse_mailbox,       "Peter Simons <@route.org:simons@cryp.to>" }
+  , { "mailbox_view_p",    parse_mailbox_view,  "Peter Simons <simons@cryp.to>" }
+  , { "recognize_mailbox", recognize_mailbox,   "Peter Simons <simons@cryp.to>" }
+  , { "route_addr_p",      parse_route_addr,    "<@route.org:simons@cryp.to>" }
+  , { "address_list_p",    visit_address_list,  "a@b, Group: \"c\" <d@e>;" }
+  , { "date_p",            parse_date,          "Thu, 04 Sep 1973 14:12:17 +0100" }
+  , { "date_p",            parse_date,          "4 Sep 73 14:12 EST" }
+  , { "recognize_date",    recognize_date,      "4 Sep 73 14:12 EST" }
+  };
+
+static boost::uint64_t time_parse(startup_case const & c)
+{
+  boost::uint64_t const t0 = bench::now_ns();
+  c.parse(c.input, c.input + strlen(c.input));
+  return bench::now_ns() - t0;
+}
+
+/// Cold parse, then the same parse warm.
+static void measure_cold(startup_case const & c, boost::uint64_t * result)
+{
+  result[0] = time_parse(c);
+  result[1] = time_parse(c);
+}
+
+/// prepare_parsers(), then the first parse.
+static void measure_prepared(startup_case const & c, boost::uint64_t * result)
+{
+  boost::uint64_t const t0 = bench::now_ns();
+  prepare_parsers();
+  result[0] = bench::now_ns() - t0;
+  result[1] = time_parse(c);
+}
+
+/// The median over five child processes of both numbers.
+static void in_child(void (*f)(startup_case const &, boost::uint64_t *), startup_case const & c, boost::uint64_t * shared, boost::uint64_t * result)
+{
+  vector<boost::uint64_t> samples[2];
+  for (size_t run = 0; run != 5u; ++run)
+  {
+    pid_t const pid = fork();
+    if (pid < 0)
+    {
+      perror("fork");
+      exit(1);
+    }
+    if (pid == 0)
+    {
+      f(c, shared);
+      _exit(0);
+    }
+    waitpid(pid, NULL, 0);
+    samples[0].push_back(shared[0]);
+    samples[1].push_back(shared[1]);
+  }
+  for (size_t i = 0; i != 2u; ++i)
+  {
+    sort(samples[i].begin(), samples[i].end());
+    result[i] = bench::percentile(samples[i], 0.5);
+  }
+}
+
+static void run_startup(bench::options const & opt)
+{
+  void * const p = mmap(NULL, 2u * sizeof(boost::uint64_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED)
+  {
+    perror("mmap");
+    exit(1);
+  }
+  boost::uint64_t * const shared = static_cast<boost::uint64_t *>(p);
+
+  printf("%-24s %-32s %12s %12s %12s %12s\n", "case", "input", "cold ns", "warm ns", "prepared ns", "prepare ns");
+  for (size_t i = 0; i != sizeof(startup_cases) / sizeof(startup_cases[0]); ++i)
+  {
+    startup_case const & c = startup_cases[i];
+    if (!opt.filter.empty() && string(c.name).find(opt.filter) == string::npos)
+      continue;
+    boost::uint64_t cold[2], prepared[2];
+    in_child(&measure_cold, c, shared, cold);
+    in_child(&measure_prepared, c, shared, prepared);
+    printf("%-24s %-32s %12lu %12lu %12lu %12lu\n", c.name, c.input,
+           (unsigned long)cold[0], (unsigned long)cold[1], (unsigned long)prepared[1], (unsigned long)prepared[0]);
+  }
+  printf("\n");
+  fflush(stdout);
+  munmap(p, 2u * sizeof(boost::uint64_t));
+}
+
+static void usage(char const * argv0)
+{
+  cerr << "Usage: " << argv0 << " [--min-time SECONDS] [--filter SUBSTRING]" << endl
+       << "       [--scaling [--max-threads N]] [--profile] [HEADER-FILE ...]" << endl
+       << endl
+       << "Runs the rfc2822 parsers over generated corpora and over the header" << endl
+       << "fields of all given files, which contain raw message headers." << endl
+       << "With --scaling, 1, 2, 4, ... up to N (default 64) threads run the same" << endl
+       << "parsers at once instead; that needs a thread-safe build." << endl
+       << "With --profile, the counters of all grammar rules are printed at the" << endl
+       << "end; that needs a profiling build." << endl;
+  exit(1);
+}
+
+int main(int argc, char ** argv)
+{
+  bench::options opt;
+  bool scaling = false;
+  bool profile = false;
+  recorded rec;
+  rec.date.name         = "recorded";
+  rec.mailbox.name      = "recorded";
+  rec.address_list.name = "recorded";
+  rec.route_addr.name   = "recorded";
+  rec.header.name       = "recorded";
+
+  for (int i = 1; i < argc; ++i)
+  {
+    string const arg(argv[i]);
+    if (arg == "--min-time" && i + 1 < argc)    opt.min_time = atof(argv[++i]);
+    else if (arg == "--filter" && i + 1 < argc) opt.filter = argv[++i];
+    else if (arg == "--scaling")                scaling = true;
+    else if (arg == "--profile")                profile = true;
+    else if (arg == "--max-threads" && i + 1 < argc) opt.max_threads = atoi(argv[++i]);
+    else if (arg[0] == '-')                     usage(argv[0]);
+    else                                        load_headers(rec, argv[i]);
+  }
+
+  bench::corpus const plain_addr     = generate("plain",     gen_plain_addr);
+  bench::corpus const messy_addr     = generate("messy",     gen_messy_addr);
+  bench::corpus const garbage_addr   = generate("garbage",   gen_garbage_addr);
+  bench::corpus const routed_addr    = generate("routed",    gen_routed_addr);
+  bench::corpus const mailboxes      = generate("mixed",     gen_mailbox);
+  bench::corpus const address_lists  = generate("lists",     gen_address_list, 200);
+  bench::corpus const huge_lists     = generate("huge",      gen_huge_list, 1);
+  bench::corpus const route_addrs    = generate("route",     gen_route_addr);
+  bench::corpus const canonical_date = generate("canonical", gen_canonical_date);
+  bench::corpus const other_date     = generate("other",     gen_other_date);
+  bench::corpus const months         = generate("months",    gen_month);
+  bench::corpus const zones          = generate("zones",     gen_zone);
+  bench::corpus const atoms          = generate("atoms",     gen_atom);
+  bench::corpus const comments       = generate("comments",  gen_comment);
+  bench::corpus const lwsps          = generate("folded",    gen_lwsp);
+  bench::corpus const quoted_strings = generate("quoted",    gen_quoted_string);
+  bench::corpus const skip_inputs    = generate("cfws",      gen_skipper);
+  bench::corpus const headers        = generate("headers",   gen_header, 500);
+  bench::corpus const mboxes         = generate("mbox",      gen_mbox, 1);
+  bench::corpus const test_addresses = from_array("tests", address_tests, address_tests + sizeof(address_tests) / sizeof(address_tests[0]));
+
+  if (scaling)
+  {
+#ifdef BOOST_SPIRIT_THREADSAFE
+    cout << boost::thread::hardware_concurrency() << " CPUs" << endl;
+    bench::count_allocations = false;
+    bench::print_scaling_header();
+    bench::run_scaling("addr_spec_p",       parse_addr_spec,       plain_addr,      opt);
+    bench::run_scaling("mailbox_p",         parse_mailbox,         mailboxes,       opt);
+    bench::run_scaling("mailbox_view_p",    parse_mailbox_view,    mailboxes,       opt);
+    bench::run_scaling("recognize_mailbox", recognize_mailbox,     mailboxes,       opt);
+    bench::run_scaling("address_list_p",    visit_address_list,    address_lists,   opt);
+    bench::run_scaling("date_p",            parse_date,            canonical_date,  opt);
+    bench::run_scaling("date_p",            parse_date,            other_date,      opt);
+    return 0;
+#else
+    cerr << "--scaling needs a library built with BOOST_SPIRIT_THREADSAFE, e.g. by configure --enable-threads." << endl;
+    return 1;
+#endif
+  }
+
+  if (profile)
+  {
+#ifndef RFC2822_PROFILE
+    cerr << "--profile needs a library built with RFC2822_PROFILE, e.g. by configure --enable-profile." << endl;
+    return 1;
+#endif
+  }
+
+  run_startup(opt);
+
+  reset_rule_profiles();
+  bench::print_header();
+  bench::run("addr_spec_p",       parse_addr_spec,       plain_addr,      opt);
+  bench::run("addr_spec_p",       parse_addr_spec,       messy_addr,      opt);
+  bench::run("addr_spec_p",       parse_addr_spec,       garbage_addr,    opt);
+  bench::run("parse_addr_spec",   precompiled_addr_spec, plain_addr,      opt);
+  bench::run("parse_addr_spec",   precompiled_addr_spec, garbage_addr,    opt);
+  bench::run("addr_spec_view_p",  parse_addr_spec_view,  plain_addr,      opt);
+  bench::run("addr_spec_view_p",  parse_addr_spec_view,  messy_addr,      opt);
+  bench::run("addr_spec_ref_p",   parse_addr_spec_ref,   plain_addr,      opt);
+  bench::run("addr_spec_ref_p",   parse_addr_spec_ref,   messy_addr,      opt);
+  bench::run("addr_spec/arena",   parse_addr_spec_arena, plain_addr,      opt);
+  bench::run("addr_spec/arena",   parse_addr_spec_arena, messy_addr,      opt);
+  bench::run("addr_spec/route",   route_by_string,       routed_addr,     opt);
+  bench::run("addr_spec/route",   route_by_string,       messy_addr,      opt);
+  bench::run("interned_addr_spec_p", route_interned,     routed_addr,     opt);
+  bench::run("interned_addr_spec_p", route_interned,     messy_addr,      opt);
+  bench::run("mailbox_p",         parse_mailbox,         plain_addr,      opt);
+  bench::run("mailbox_p",         parse_mailbox,         mailboxes,       opt);
+  bench::run("mailbox_p",         parse_mailbox,         rec.mailbox,     opt);
+  bench::run("mailbox_p",         parse_mailbox,         test_addresses,  opt);
+  bench::run("parse_mailbox",     precompiled_mailbox,   mailboxes,       opt);
+  bench::run("mailbox_view_p",    parse_mailbox_view,    plain_addr,      opt);
+  bench::run("mailbox_view_p",    parse_mailbox_view,    mailboxes,       opt);
+  bench::run("mailbox_view_p",    parse_mailbox_view,    rec.mailbox,     opt);
+  bench::run("mailbox_ref_p",     parse_mailbox_ref,     plain_addr,      opt);
+  bench::run("mailbox_ref_p",     parse_mailbox_ref,     mailboxes,       opt);
+  bench::run("mailbox_ref_p",     parse_mailbox_ref,     rec.mailbox,     opt);
+  bench::run("mailbox/arena",     parse_mailbox_arena,   plain_addr,      opt);
+  bench::run("mailbox/arena",     parse_mailbox_arena,   mailboxes,       opt);
+  bench::run("mailbox/arena",     parse_mailbox_arena,   rec.mailbox,     opt);
+  bench::run("recognize_addr_spec", recognize_addr_spec,   plain_addr,      opt);
+  bench::run("recognize_addr_spec", recognize_addr_spec,   messy_addr,      opt);
+  bench::run("recognize_addr_spec", recognize_addr_spec,   garbage_addr,    opt);
+  bench::run("recognize_mailbox", recognize_mailbox,     mailboxes,       opt);
+  bench::run("recognize_mailbox", recognize_mailbox,     rec.mailbox,     opt);
+  bench::run("address_list_p",    visit_address_list,    address_lists,   opt);
+  bench::run("address_list_p",    visit_address_list,    rec.address_list, opt);
+  bench::run("parse_address_list/1", parse_address_list_single, huge_lists, opt);
+  bench::run("parse_address_list", parse_address_list_all, huge_lists,     opt);
+  bench::run("route_addr_p",      parse_route_addr,      route_addrs,     opt);
+  bench::run("route_addr_p",      parse_route_addr,      rec.route_addr,  opt);
+  bench::run("recognize_route_addr", recognize_route_addr,  rec.route_addr,  opt);
+  bench::run("date_p",            parse_date,            canonical_date,  opt);
+  bench::run("date_p",            parse_date,            other_date,      opt);
+  bench::run("date_p",            parse_date,            rec.date,        opt);
+  bench::run("parse_date",        precompiled_date,      canonical_date,  opt);
+  bench::run("recognize_date",    recognize_date,        canonical_date,  opt);
+  bench::run("recognize_date",    recognize_date,        other_date,      opt);
+  bench::run("date_p+mktime",     parse_date_mktime,     canonical_date,  opt);
+  bench::run("date_p+epoch",      parse_date_epoch,      canonical_date,  opt);
+  bench::run("month_p",           parse_month,           months,          opt);
+  bench::run("timezone_p",        parse_timezone,        zones,           opt);
+  bench::run("atom_p",            parse_atom,            atoms,           opt);
+  bench::run("comment_p",         parse_comment,         comments,        opt);
+  bench::run("lwsp_p",            parse_lwsp,            lwsps,           opt);
+  bench::run("quoted_string_p",   parse_quoted_string,   quoted_strings,  opt);
+  bench::run("skipper_p",         parse_skipper,         skip_inputs,     opt);
+  bench::run("split_header",      parse_header,          headers,         opt);
+  bench::run("split_header",      parse_header,          rec.header,      opt);
+  bench::run("header_stream/64",  parse_header_stream,   headers,         opt);
+  bench::run("header_stream/64",  parse_header_stream,   rec.header,      opt);
+  bench::run("split_header/64",   parse_header_resplit,  headers,         opt);
+  bench::run("parse_mbox/1",      parse_mbox_single,     mboxes,          opt);
+  bench::run("parse_mbox",        parse_mbox_all,        mboxes,          opt);
+
+  if (profile)
+  {
+    cout << endl;
+    dump_rule_profiles(cout);
+  }
+
+  return 0;
+}
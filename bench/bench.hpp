@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_BENCH_HPP_INCLUDED
+#define RFC2822_BENCH_HPP_INCLUDED
+
+#include <rfc2822/config.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <time.h>
+
+#ifdef BOOST_SPIRIT_THREADSAFE
+#  include <boost/bind/bind.hpp>
+#  include <boost/ref.hpp>
+#  include <boost/thread/barrier.hpp>
+#  include <boost/thread/thread.hpp>
+#endif
+
+namespace bench
+{
+  /// A corpus is a list of input strings, each of which is parsed on its own.
+  struct corpus
+  {
+    std::string                 name;
+    std::vector<std::string>    inputs;
+
+    std::size_t bytes() const
+    {
+      std::size_t n = 0;
+      for (std::size_t i = 0; i != inputs.size(); ++i) n += inputs[i].size();
+      return n;
+    }
+  };
+
+  /// Runs the parser over [first, last) and returns the stop position or NULL.
+  typedef char const * (*parse_function)(char const * first, char const * last);
+
+  inline boost::uint64_t now_ns()
+  {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return boost::uint64_t(ts.tv_sec) * 1000000000u + ts.tv_nsec;
+  }
+
+  /// Number of calls to operator new since program start. Defined by the
+  /// benchmark driver, which replaces the global allocation functions.
+  extern unsigned long allocations;
+
+  /// Whether operator new counts. All threads share the counter, so the
+  /// scaling runs turn it off.
+  extern bool count_allocations;
+
+  struct options
+  {
+    double              min_time;       ///< seconds spent per case
+    std::string         filter;         ///< run only cases containing this
+    unsigned            max_threads;    ///< scaling runs go up to this many threads
+    options() : min_time(0.5), max_threads(64u) { }
+  };
+
+  struct result
+  {
+    std::size_t         parses;
+    std::size_t         hits;
+    double              seconds;
+    double              mb_per_s;
+    double              parses_per_s;
+    boost::uint64_t     p50, p99, p999;
+    double              allocs_per_parse;
+  };
+
+  inline boost::uint64_t percentile(std::vector<boost::uint64_t> const & sorted, double p)
+  {
+    if (sorted.empty()) return 0;
+    std::size_t i = std::size_t(p * double(sorted.size() - 1) + 0.5);
+    return sorted[std::min(i, sorted.size() - 1)];
+  }
+
+  /// Time every single parse of every input in the corpus, over and over
+  /// again until at least opt.min_time seconds have been spent.
+  inline result measure(parse_function f, corpus const & c, options const & opt)
+  {
+    result r;
+    r.parses = r.hits = 0;
+    std::vector<boost::uint64_t> samples;
+
+    // One untimed pass so that lazily constructed grammar definitions don't
+    // show up in the latency distribution.
+    for (std::size_t i = 0; i != c.inputs.size(); ++i)
+      f(c.inputs[i].data(), c.inputs[i].data() + c.inputs[i].size());
+
+    boost::uint64_t const budget = boost::uint64_t(opt.min_time * 1e9);
+    boost::uint64_t total = 0, bytes = 0;
+    unsigned long allocs = 0;
+    while (total < budget && !c.inputs.empty())
+    {
+      for (std::size_t i = 0; i != c.inputs.size(); ++i)
+      {
+        char const * const first = c.inputs[i].data();
+        char const * const last  = first + c.inputs[i].size();
+        unsigned long const a0   = allocations;
+        boost::uint64_t const t0 = now_ns();
+        char const * const stop  = f(first, last);
+        boost::uint64_t const dt = now_ns() - t0;
+        allocs += allocations - a0;
+        samples.push_back(dt);
+        total += dt;
+        bytes += last - first;
+        if (stop) ++r.hits;
+      }
+      r.parses += c.inputs.size();
+    }
+
+    std::sort(samples.begin(), samples.end());
+    r.seconds          = double(total) / 1e9;
+    r.mb_per_s         = r.seconds > 0 ? double(bytes) / 1e6 / r.seconds : 0;
+    r.parses_per_s     = r.seconds > 0 ? double(r.parses) / r.seconds : 0;
+    r.p50              = percentile(samples, 0.50);
+    r.p99              = percentile(samples, 0.99);
+    r.p999             = percentile(samples, 0.999);
+    r.allocs_per_parse = r.parses ? double(allocs) / double(r.parses) : 0;
+    return r;
+  }
+
+  inline void print_header()
+  {
+    std::printf("%-24s %-14s %8s %9s %11s %8s %8s %8s %8s %6s\n",
+                "case", "corpus", "inputs", "MB/s", "parses/s",
+                "p50 ns", "p99 ns", "p999 ns", "allocs", "hit%");
+  }
+
+  inline void print_result(char const * name, corpus const & c, result const & r)
+  {
+    std::printf("%-24s %-14s %8lu %9.2f %11.0f %8lu %8lu %8lu %8.2f %6.1f\n",
+                name, c.name.c_str(), (unsigned long)c.inputs.size(),
+                r.mb_per_s, r.parses_per_s,
+                (unsigned long)r.p50, (unsigned long)r.p99, (unsigned long)r.p999,
+                r.allocs_per_parse,
+                r.parses ? 100.0 * double(r.hits) / double(r.parses) : 0.0);
+    std::fflush(stdout);
+  }
+
+  inline void run(char const * name, parse_function f, corpus const & c, options const & opt)
+  {
+    if (!opt.filter.empty() && std::string(name).find(opt.filter) == std::string::npos)
+      return;
+    if (c.inputs.empty())
+      return;
+    print_result(name, c, measure(f, c, opt));
+  }
+
+#ifdef BOOST_SPIRIT_THREADSAFE
+
+  struct thread_totals
+  {
+    std::size_t         parses;
+    boost::uint64_t     bytes;
+    boost::uint64_t     ns;
+  };
+
+  /// Parse the corpus over and over again, starting once all threads have
+  /// reached the barrier, until opt.min_time seconds have passed.
+  inline void parse_for(parse_function f, corpus const & c, options const & opt, boost::barrier & start, thread_totals & t)
+  {
+    // Every thread builds its own grammar definitions; not part of the
+    // measurement either.
+    for (std::size_t i = 0; i != c.inputs.size(); ++i)
+      f(c.inputs[i].data(), c.inputs[i].data() + c.inputs[i].size());
+
+    t.parses = 0;
+    t.bytes  = 0;
+    start.wait();
+    boost::uint64_t const budget = boost::uint64_t(opt.min_time * 1e9);
+    boost::uint64_t const t0 = now_ns();
+    do
+    {
+      for (std::size_t i = 0; i != c.inputs.size(); ++i)
+      {
+        f(c.inputs[i].data(), c.inputs[i].data() + c.inputs[i].size());
+        t.bytes += c.inputs[i].size();
+      }
+      t.parses += c.inputs.size();
+    }
+    while ((t.ns = now_ns() - t0) < budget);
+  }
+
+  /// Throughput of \p threads threads parsing the same corpus with the
+  /// same parser objects at once.
+  inline result measure_threads(parse_function f, corpus const & c, options const & opt, unsigned threads)
+  {
+    std::vector<thread_totals> totals(threads);
+    boost::barrier start(threads);
+    {
+      boost::thread_group workers;
+      for (unsigned i = 0; i != threads; ++i)
+        workers.create_thread(boost::bind(&parse_for, f, boost::cref(c), boost::cref(opt), boost::ref(start), boost::ref(totals[i])));
+      workers.join_all();
+    }
+
+    result r = result();
+    boost::uint64_t bytes = 0, ns = 0;
+    for (unsigned i = 0; i != threads; ++i)
+    {
+      r.parses += totals[i].parses;
+      bytes    += totals[i].bytes;
+      ns        = std::max(ns, totals[i].ns);
+    }
+    r.seconds      = double(ns) / 1e9;
+    r.mb_per_s     = r.seconds > 0 ? double(bytes) / 1e6 / r.seconds : 0;
+    r.parses_per_s = r.seconds > 0 ? double(r.parses) / r.seconds : 0;
+    return r;
+  }
+
+  inline void print_scaling_header()
+  {
+    std::printf("%-24s %-14s %8s %9s %11s %8s %6s\n",
+                "case", "corpus", "threads", "MB/s", "parses/s", "speedup", "eff%");
+  }
+
+  /// Measure with 1, 2, 4, ... threads up to opt.max_threads. Speedup is
+  /// relative to one thread; efficiency is speedup per thread.
+  inline void run_scaling(char const * name, parse_function f, corpus const & c, options const & opt)
+  {
+    if (!opt.filter.empty() && std::string(name).find(opt.filter) == std::string::npos)
+      return;
+    if (c.inputs.empty())
+      return;
+    double single = 0;
+    for (unsigned threads = 1; threads <= opt.max_threads; threads *= 2)
+    {
+      result const r = measure_threads(f, c, opt, threads);
+      if (threads == 1) single = r.mb_per_s;
+      double const speedup = single > 0 ? r.mb_per_s / single : 0;
+      std::printf("%-24s %-14s %8u %9.2f %11.0f %8.2f %6.1f\n",
+                  name, c.name.c_str(), threads, r.mb_per_s, r.parses_per_s,
+                  speedup, 100.0 * speedup / threads);
+      std::fflush(stdout);
+    }
+  }
+
+#endif // BOOST_SPIRIT_THREADSAFE
+
+} // bench
+
+#endif // RFC2822_BENCH_HPP_INCLUDED
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/mbox.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+// Print one line per message: offset and size in the file, the date as
+// seconds since the epoch, and the addresses of From, Sender, To, and Cc.
+// Fields are separated by tabs, addresses by commas; missing fields are
+// printed as "-".
+
+using namespace std;
+using namespace rfc2822;
+
+static void print_list(vector<string> const & l)
+{
+  if (l.empty())
+    fputs("\t-", stdout);
+  for (size_t i = 0; i != l.size(); ++i)
+  {
+    putchar(i ? ',' : '\t');
+    fputs(l[i].c_str(), stdout);
+  }
+}
+
+static void print_message(mbox_message const & msg)
+{
+  printf("%lu\t%lu", (unsigned long)msg.offset, (unsigned long)msg.size);
+  if (msg.has_date)
+    printf("\t%lld", (long long)epoch_seconds(msg.date));
+  else
+    fputs("\t-", stdout);
+  print_list(msg.from);
+  printf("\t%s", msg.sender.empty() ? "-" : msg.sender.c_str());
+  print_list(msg.to);
+  print_list(msg.cc);
+  putchar('\n');
+}
+
+static void usage(char const * argv0)
+{
+  cerr << "Usage: " << argv0 << " [--threads N] [--batch-size BYTES] MBOX ..." << endl;
+  exit(1);
+}
+
+int main(int argc, char ** argv)
+{
+  mbox_options opt;
+  int i = 1;
+  for (; i < argc && argv[i][0] == '-'; ++i)
+  {
+    string const arg(argv[i]);
+    if (arg == "--threads" && i + 1 < argc)         opt.threads = atoi(argv[++i]);
+    else if (arg == "--batch-size" && i + 1 < argc) opt.batch_size = strtoul(argv[++i], 0, 10);
+    else                                            usage(argv[0]);
+  }
+  if (i == argc)
+    usage(argv[0]);
+
+  try
+  {
+    for (; i < argc; ++i)
+    {
+      mapped_file const mbox(argv[i]);
+      parse_mbox(mbox.begin(), mbox.end(), &print_message, opt);
+    }
+  }
+  catch(exception const & e)
+  {
+    cerr << argv[0] << ": " << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
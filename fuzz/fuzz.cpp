@@ -0,0 +1,357 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+// The offline fuzzing driver. Without file arguments, it runs every target
+// over its seeds and over random mutations of them, comparing each parser
+// with the reference grammar, and then checks that parse time grows
+// linearly with input length. With file arguments, it runs the checks over
+// those files only, which is how AFL calls it:
+//
+//   afl-fuzz -i corpus -o findings -- rfc2822-fuzz --target addr_spec @@
+
+#include "fuzz.hpp"
+#include "rfc2822/base.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+using namespace std;
+using fuzz::target;
+
+namespace
+{
+  // A deterministic generator, so that a run can be repeated with --seed.
+
+  struct xorshift
+  {
+    explicit xorshift(boost::uint64_t seed) : state(seed ? seed : 1u) { }
+
+    boost::uint64_t operator() ()
+    {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      return state;
+    }
+
+    size_t below(size_t n) { return n ? static_cast<size_t>((*this)() % n) : 0u; }
+
+    boost::uint64_t state;
+  };
+
+  char const interesting[] = " \t\r\n()<>[]@.,:;\"\\";
+
+  string mutate(string s, vector<string> const & seeds, xorshift & rnd)
+  {
+    for (size_t n = 1u + rnd.below(4u); n; --n)
+    {
+      size_t const pos( rnd.below(s.size() + 1u) );
+      switch (rnd.below(5u))
+      {
+        case 0:
+          if (pos < s.size()) s[pos] = static_cast<char>(rnd.below(256u));
+          break;
+        case 1:
+          s.insert(pos, 1u, interesting[rnd.below(sizeof(interesting) - 1u)]);
+          break;
+        case 2:
+          if (pos < s.size()) s.erase(pos, 1u);
+          break;
+        case 3:
+        {
+          size_t const len( rnd.below(s.size() - pos + 1u) );
+          s.insert(pos, s.substr(pos, len));
+          break;
+        }
+        case 4:
+        {
+          string const & other( seeds[rnd.below(seeds.size())] );
+          s = s.substr(0u, pos) + other.substr(rnd.below(other.size() + 1u));
+          break;
+        }
+      }
+    }
+    return s;
+  }
+
+  void check(target const & t, string const & input)
+  {
+    t.check(input.data(), input.data() + input.size());
+  }
+
+  /**
+   *  Inputs that grow by repeating one part of a seed: the whole seed, or
+   *  the first occurrence of each character that opens a nested or
+   *  repeated construct. A fold repeats as a whole.
+   */
+  struct growth_pattern
+  {
+    string      prefix;
+    string      unit;
+    string      suffix;
+
+    string input(size_t repeat) const
+    {
+      string s( prefix );
+      s.reserve(prefix.size() + unit.size() * repeat + suffix.size());
+      while (repeat--) s += unit;
+      return s + suffix;
+    }
+  };
+
+  vector<growth_pattern> growth_patterns(string const & seed)
+  {
+    vector<growth_pattern> patterns;
+    if (seed.empty())
+      return patterns;
+    growth_pattern whole;
+    whole.unit = seed;
+    patterns.push_back(whole);
+
+    char const openers[] = "(\"\\\r <@[.,:";
+    for (char const * c = openers; *c; ++c)
+    {
+      string::size_type const pos( seed.find(*c) );
+      if (pos == string::npos)
+        continue;
+      size_t len( 1u );
+      if (*c == '\r' && seed.compare(pos, 2u, "\r\n") == 0 && pos + 2u < seed.size())
+        len = 3u;
+      growth_pattern p;
+      p.prefix = seed.substr(0u, pos);
+      p.unit   = seed.substr(pos, len);
+      p.suffix = seed.substr(pos + len);
+      patterns.push_back(p);
+    }
+    return patterns;
+  }
+
+  /// Nanoseconds per parse of \p input, measured over at least a millisecond.
+  double time_per_parse(fuzz::parse_function parse, string const & input)
+  {
+    char const * const first = input.data();
+    char const * const last  = first + input.size();
+    size_t runs( 0u );
+    boost::uint64_t const start( fuzz::now_ns() );
+    boost::uint64_t elapsed( 0u );
+    do
+    {
+      for (size_t i = 0; i != 16u; ++i)
+        parse(first, last);
+      runs += 16u;
+      elapsed = fuzz::now_ns() - start;
+    }
+    while (elapsed < 1000000u);
+    return double(elapsed) / double(runs);
+  }
+
+  /// How parse time grows with input length: 1 is linear, 2 quadratic.
+  double growth_exponent(fuzz::parse_function parse, growth_pattern const & p, size_t small)
+  {
+    size_t const factor( 16u );
+    string const a( p.input(small) );
+    string const b( p.input(small * factor) );
+    // Timing is noisy; only a suspicious result is measured again.
+    double best( 1e9 );
+    for (int attempt = 0; attempt != 3 && best > 1.0; ++attempt)
+    {
+      double const ta( time_per_parse(parse, a) );
+      double const tb( time_per_parse(parse, b) );
+      best = std::min(best, std::log(tb / ta) / std::log(double(b.size()) / double(a.size())));
+    }
+    return best;
+  }
+
+  struct options
+  {
+    string              target;
+    size_t              mutations;
+    boost::uint64_t     seed;
+    bool                complexity;
+    double              max_exponent;
+    string              corpus_dir;
+    vector<string>      files;
+
+    options() : mutations(200u), seed(1u), complexity(true), max_exponent(1.5) { }
+  };
+
+  void usage(char const * self)
+  {
+    fprintf( stderr
+           , "Usage: %s [options] [file ...]\n"
+             "  --target NAME         only fuzz the given parser\n"
+             "  --mutations N         random mutations per seed [200]\n"
+             "  --seed N              seed of the mutation generator [1]\n"
+             "  --no-complexity       skip the check that parse time grows linearly\n"
+             "  --max-exponent X      fail if parse time grows faster than length^X [1.5]\n"
+             "  --write-corpus DIR    write the seeds into DIR, one file each, and exit\n"
+             "With files, the checks run over them only.\n"
+             "Targets:"
+           , self
+           );
+    for (size_t i = 0; i != fuzz::targets().size(); ++i)
+      fprintf(stderr, " %s", fuzz::targets()[i].name);
+    fprintf(stderr, "\n");
+    exit(2);
+  }
+
+  options parse_options(int argc, char ** argv)
+  {
+    options opt;
+    for (int i = 1; i < argc; ++i)
+    {
+      string const arg( argv[i] );
+      bool const has_value( i + 1 < argc );
+      if (arg == "--target" && has_value)
+      {
+        opt.target = argv[++i];
+        if (!fuzz::find_target(opt.target))
+          usage(argv[0]);
+      }
+      else if (arg == "--mutations" && has_value)       opt.mutations    = strtoul(argv[++i], 0, 10);
+      else if (arg == "--seed" && has_value)            opt.seed         = strtoull(argv[++i], 0, 10);
+      else if (arg == "--no-complexity")                opt.complexity   = false;
+      else if (arg == "--max-exponent" && has_value)    opt.max_exponent = atof(argv[++i]);
+      else if (arg == "--write-corpus" && has_value)    opt.corpus_dir   = argv[++i];
+      else if (arg.compare(0u, 2u, "--") == 0)          usage(argv[0]);
+      else                                              opt.files.push_back(arg);
+    }
+    return opt;
+  }
+
+  bool selected(options const & opt, target const & t)
+  {
+    return opt.target.empty() || opt.target == t.name;
+  }
+
+  string read_file(string const & path)
+  {
+    ifstream is(path.c_str(), ios::in | ios::binary);
+    if (!is)
+    {
+      fprintf(stderr, "cannot open %s\n", path.c_str());
+      exit(2);
+    }
+    return string(istreambuf_iterator<char>(is), istreambuf_iterator<char>());
+  }
+
+  void write_corpus(options const & opt)
+  {
+    for (size_t i = 0; i != fuzz::targets().size(); ++i)
+    {
+      target const & t( fuzz::targets()[i] );
+      if (!selected(opt, t))
+        continue;
+      for (size_t n = 0; n != t.seeds.size(); ++n)
+      {
+        ostringstream path;
+        path << opt.corpus_dir << '/' << t.name << '-' << n;
+        ofstream os(path.str().c_str(), ios::out | ios::binary);
+        os.write(t.seeds[n].data(), static_cast<streamsize>(t.seeds[n].size()));
+        if (!os)
+        {
+          fprintf(stderr, "cannot write %s\n", path.str().c_str());
+          exit(2);
+        }
+      }
+    }
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  options const opt( parse_options(argc, argv) );
+  rfc2822::prepare_parsers();
+
+  if (!opt.corpus_dir.empty())
+  {
+    write_corpus(opt);
+    return 0;
+  }
+
+  vector<target> const & targets( fuzz::targets() );
+
+  if (!opt.files.empty())
+  {
+    for (size_t f = 0; f != opt.files.size(); ++f)
+    {
+      string const input( read_file(opt.files[f]) );
+      for (size_t i = 0; i != targets.size(); ++i)
+        if (selected(opt, targets[i]))
+          check(targets[i], input);
+    }
+    return 0;
+  }
+
+  int failures( 0 );
+  printf("%-16s %8s %10s %9s %9s  %s\n", "target", "seeds", "mutations", "patterns", "exponent", "worst pattern");
+  for (size_t i = 0; i != targets.size(); ++i)
+  {
+    target const & t( targets[i] );
+    if (!selected(opt, t))
+      continue;
+
+    xorshift rnd(opt.seed);
+    for (size_t n = 0; n != t.seeds.size(); ++n)
+    {
+      check(t, t.seeds[n]);
+      for (size_t m = 0; m != opt.mutations; ++m)
+        check(t, mutate(t.seeds[n], t.seeds, rnd));
+    }
+
+    size_t patterns( 0u );
+    double worst( 0.0 );
+    string worst_input;
+    if (opt.complexity)
+    {
+      for (size_t n = 0; n != t.seeds.size(); ++n)
+      {
+        vector<growth_pattern> const growth( growth_patterns(t.seeds[n]) );
+        for (size_t g = 0; g != growth.size(); ++g)
+        {
+          growth_pattern const & p( growth[g] );
+          size_t const small( 256u / p.unit.size() + 1u );
+          check(t, p.input(small));
+          double const e( growth_exponent(t.parse, p, small) );
+          ++patterns;
+          string const shown( fuzz::quote(p.prefix.data(), p.prefix.data() + p.prefix.size())
+                            + " + " + fuzz::quote(p.unit.data(), p.unit.data() + p.unit.size())
+                            + "*n + " + fuzz::quote(p.suffix.data(), p.suffix.data() + p.suffix.size())
+                            );
+          if (e > opt.max_exponent)
+          {
+            fprintf(stderr, "%s: parse time grows like length^%.2f for %s\n", t.name, e, shown.c_str());
+            ++failures;
+          }
+          if (e > worst || worst_input.empty())
+          {
+            worst       = e;
+            worst_input = shown;
+          }
+        }
+      }
+    }
+
+    printf( "%-16s %8lu %10lu %9lu %9.2f  %s\n", t.name
+          , static_cast<unsigned long>(t.seeds.size())
+          , static_cast<unsigned long>(t.seeds.size() * opt.mutations)
+          , static_cast<unsigned long>(patterns)
+          , worst, worst_input.c_str()
+          );
+  }
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_FUZZ_HPP_INCLUDED
+#define RFC2822_FUZZ_HPP_INCLUDED
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <time.h>
+
+namespace fuzz
+{
+  /// Runs the parser over [first, last) and returns the stop position or NULL.
+  typedef char const * (*parse_function)(char const * first, char const * last);
+
+  /// Runs every parser that implements the target's language over [first,
+  /// last) and calls failure() if any two of them disagree.
+  typedef void (*check_function)(char const * first, char const * last);
+
+  /**
+   *  One of the public parsers. \c parse runs the parser itself, as the
+   *  complexity check times it; \c check compares it with the reference
+   *  grammar and with every other parser for the same language: the
+   *  recognizer, the views, the precompiled and the budgeted variants.
+   */
+  struct target
+  {
+    char const *                name;
+    parse_function              parse;
+    check_function              check;
+    std::vector<std::string>    seeds;
+  };
+
+  /// All targets, with their seeds.
+  std::vector<target> const & targets();
+
+  /// The target of the given name, or \c NULL.
+  target const * find_target(std::string const & name);
+
+  /// \name Seed corpus, from the cases in test/address.cpp and test/date.cpp.
+  //@{
+  std::vector<std::string> address_seeds();
+  std::vector<std::string> comment_seeds();
+  std::vector<std::string> domain_literal_seeds();
+  std::vector<std::string> date_seeds();
+  //@}
+
+  /// Report a disagreement between two parsers and abort, so that the
+  /// fuzzer keeps the input.
+  void failure(char const * target, char const * what, char const * first, char const * last);
+
+  /// The input as a C string literal, for failure reports.
+  std::string quote(char const * first, char const * last);
+
+  inline boost::uint64_t now_ns()
+  {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return boost::uint64_t(ts.tv_sec) * 1000000000u + ts.tv_nsec;
+  }
+
+} // fuzz
+
+#define RFC2822_FUZZ_CHECK(TARGET, COND, FIRST, LAST)           \
+  do                                                            \
+  {                                                             \
+    if (!(COND))                                                \
+      ::fuzz::failure(TARGET, #COND, FIRST, LAST);              \
+  }                                                             \
+  while (false)
+
+#endif // RFC2822_FUZZ_HPP_INCLUDED
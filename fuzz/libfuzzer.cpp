@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+// The libFuzzer entry point for one target, chosen at compile time:
+//
+//   clang++ -fsanitize=fuzzer,address -DRFC2822_FUZZ_TARGET=addr_spec \
+//     -I. fuzz/libfuzzer.cpp fuzz/targets.cpp fuzz/seeds.cpp src/*.cpp
+//   rfc2822-fuzz --target addr_spec --write-corpus corpus
+//   ./a.out corpus
+//
+// AFL++ builds the same file with afl-clang-fast++ -fsanitize=fuzzer.
+
+#include "fuzz.hpp"
+#include "rfc2822/base.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <boost/preprocessor/stringize.hpp>
+
+#ifndef RFC2822_FUZZ_TARGET
+#  error "Define RFC2822_FUZZ_TARGET to the parser to fuzz, e.g. addr_spec."
+#endif
+
+namespace
+{
+  fuzz::target const * the_target( 0 );
+}
+
+extern "C" int LLVMFuzzerInitialize(int *, char ***)
+{
+  rfc2822::prepare_parsers();
+  the_target = fuzz::find_target(BOOST_PP_STRINGIZE(RFC2822_FUZZ_TARGET));
+  if (!the_target)
+  {
+    std::fprintf(stderr, "unknown fuzz target %s\n", BOOST_PP_STRINGIZE(RFC2822_FUZZ_TARGET));
+    std::abort();
+  }
+  return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(unsigned char const * data, std::size_t size)
+{
+  char const * const first = reinterpret_cast<char const *>(data);
+  the_target->check(first, first + size);
+  return 0;
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_FUZZ_REFERENCE_HPP_INCLUDED
+#define RFC2822_FUZZ_REFERENCE_HPP_INCLUDED
+
+#include "rfc2822/address.hpp"
+#include "rfc2822/lwsp.hpp"
+#include "rfc2822/quoted-pair.hpp"
+
+// The grammars as they were written before any fast path went in: every
+// address goes through local_part_p and domain_p, mailbox_p tries a
+// display name and backtracks, and comments recurse. The fast paths must
+// accept exactly the same language and produce the same results.
+
+namespace fuzz
+{
+  namespace spirit = rfc2822::spirit;
+
+  typedef rfc2822::basic_string_closure<std::string> string_closure;
+
+  struct reference_addr_spec_parser : public spirit::grammar<reference_addr_spec_parser, string_closure::context_t>
+  {
+    reference_addr_spec_parser() { }
+
+    template<typename scannerT>
+    struct definition
+    {
+      spirit::rule<scannerT>    addr_spec;
+
+      definition(reference_addr_spec_parser const & self)
+      {
+        using namespace spirit;
+        using namespace phoenix;
+        using namespace rfc2822;
+
+        addr_spec
+          = local_part_p [self.val += arg1]
+            >> ch_p('@') [self.val += '@']
+            >> domain_p  [self.val += arg1]
+          ;
+      }
+
+      spirit::rule<scannerT> const & start() const { return addr_spec; }
+    };
+  };
+
+  struct reference_route_addr_parser : public spirit::grammar<reference_route_addr_parser, string_closure::context_t>
+  {
+    reference_route_addr_parser() { }
+
+    template<typename scannerT>
+    struct definition
+    {
+      reference_addr_spec_parser const  addr_spec;
+      spirit::rule<scannerT>            route_addr;
+      spirit::rule<scannerT>            route;
+      spirit::rule<scannerT>            hop;
+
+      definition(reference_route_addr_parser const & self)
+      {
+        using namespace spirit;
+        using namespace phoenix;
+        using namespace rfc2822;
+
+        route_addr
+          = ch_p('<')           [self.val += '<' ]
+            >> !route
+            >> addr_spec        [self.val += arg1]
+            >> ch_p('>')        [self.val += '>' ]
+          ;
+
+        route
+          = hop
+            >> *(  ch_p(',')     [self.val += ',' ]
+                >> hop
+                )
+            >> ch_p(':')        [self.val += ':']
+          ;
+
+        hop
+          = ch_p('@')           [self.val += '@' ]
+            >> domain_p         [self.val += arg1]
+          ;
+      }
+
+      spirit::rule<scannerT> const & start() const { return route_addr; }
+    };
+  };
+
+  struct reference_mailbox_parser : public spirit::grammar<reference_mailbox_parser, string_closure::context_t>
+  {
+    reference_mailbox_parser() { }
+
+    template<typename scannerT>
+    struct definition
+    {
+      reference_addr_spec_parser const  addr_spec;
+      reference_route_addr_parser const route_addr;
+      spirit::rule<scannerT>            phrase;
+      spirit::rule<scannerT>            mailbox;
+
+      definition(reference_mailbox_parser const & self)
+      {
+        using namespace spirit;
+        using namespace phoenix;
+        using namespace rfc2822;
+
+        phrase  = word_p >> *( word_p | '.' );
+
+        mailbox = (   !phrase >> route_addr     [self.val = arg1]
+                  |   addr_spec                 [self.val = arg1]
+                  );
+      }
+
+      spirit::rule<scannerT> const & start() const { return mailbox; }
+    };
+  };
+
+  struct reference_comment_parser : public spirit::grammar<reference_comment_parser>
+  {
+    reference_comment_parser() { }
+
+    template<typename scannerT>
+    struct definition
+    {
+      spirit::rule<scannerT>    top;
+      spirit::subrule<0>        comment;
+      spirit::subrule<1>        ctext;
+
+      definition(reference_comment_parser const &)
+      {
+        using namespace spirit;
+        using namespace rfc2822;
+
+        top
+          = lexeme_d
+            [ comment = ch_p('(') >> *( lwsp_p | ctext | quoted_pair_p | comment ) >> ')'
+            , ctext   = anychar_p - (chset_p("()\\") | cr_p)
+            ]
+          ;
+      }
+
+      spirit::rule<scannerT> const & start() const { return top; }
+    };
+  };
+
+} // fuzz
+
+#endif // RFC2822_FUZZ_REFERENCE_HPP_INCLUDED
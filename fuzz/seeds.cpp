@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "fuzz.hpp"
+
+// The seed corpus: the inputs of test/address.cpp and test/date.cpp, and
+// the comments and domain literals they contain. Keep these in step with
+// the tests when adding cases there.
+
+namespace
+{
+  char const * const addresses[] =
+    { "peter\r\n . \r\n simons @ (Peter) cryp.to"
+    , "peter\r\n . \r\n simons @ [127\r\n  .0\r\n\t.0.1]"
+    , "normal . address @ example\r\n\t.org"
+    , "normal .  @ example\r\n\t.org"
+    , "peter\r\n . \r\n simons @ [127\r\n  .0\r\n.0.1]"
+    , "peter . simons @ cryp.to.\"b\"@c"
+    , "< normal . address @ example\r\n\t.org >"
+    , "< @yahoo.org\r\n : normal . address @ example\r\n\t.org >"
+    , "< @yahoo.org,@hugelwurz.cys.de:normal . address @ example\r\n\t.org >"
+    , "< @yahoo.org normal . address @ example\r\n\t.org >"
+    , "< @yahoo.org,,: normal . address @ example\r\n\t.org >"
+    , " Peter Simons < normal . address @ example\r\n\t.org >"
+    , " Dr. Foo Bar < foo . bar @ example\r\n\t.org >"
+    , "normal . address @ example\r\n\t.org (Peter Simnos)"
+    , "Dies \"ist \\\" > ein\" Test <@yahoo.org,@hugelwurz.cys.de:\"normal . address \"@ example\r\n\t.org >"
+    , " Peter < simons < @yahoo.org normal . address @ example\r\n\t.org >"
+    , " Dr. Foo (Bar) <@yahoo.org,@hugelwurz.cys.de: foo . bar @ example\r\n\t.org >"
+    , "simons@cryp.to", "peter.simons@cryp.to", "a@b", "a@b.c.d.e", "  a@b", "\r\n a@b"
+    , "a@b>", "a@b,c@d", "a@b;", "a@b@c", "a@b\"x\"", "a@b]", "a@b[", "a@b\x01", "a@b\nfoo", "a@b)"
+    , "a@b ", "a@b (comment)", "a@b (comment) .c", "a@b\r\n .c", "a@b\r\nc", "a@b\r", "a@b\t.c"
+    , "a@b.", "a@b..c", "a@b.[1.2.3.4]", "a@[1.2.3.4]", "a@b.(x)c"
+    , "a.@b", ".a@b", "a..b@c", "\"a b\"@c", "a.\"b\"@c", "a @b", "a(x)@b", "a\r\n @b", "@b", "a@", "a", ""
+    , "\xe4\xf6\xfc@example.org", "a\x7f@b", "a@b\x7f", "a!#$%&'*+/=?^_`{|}~@b", "a\\b@c"
+    , "user@example.org (Name)", "Peter Simons <simons@cryp.to>", "<simons@cryp.to>"
+    , "\"Peter Simons\" <simons@cryp.to>", "Peter . Simons <simons@cryp.to>", "Dr. Foo <a@b>", "a.b.c <a@b>"
+    , ". <a@b>", "a@b <c@d>", "a <@x,@y:b@c>", "a b@c", "a.b@c", "\"a b\"@c (d)", "a (b) . c @ d"
+    , "a (b) c <d@e>", "a <b", "a <b@c", "<a@b", "@a"
+    , "< a@b>", "<a@b >", "<a@b (x)>", "<@x,@y:b@c>", "a.b <c@d>e", "\"Peter \\\"S.\\\"\" (x) <a.b@c.d>"
+    , "Joe Q. Public <john.q.public@example.com>"
+    , "Mary Smith <@machine.tld:mary@example.net>"
+    , "Pete(A wonderful \\) chap) <pete(his account)@silly.test(his host)>"
+    , "jdoe@[192.168.0.1]"
+    };
+
+  char const * const comments[] =
+    { "(Peter)", "(comment)", "(x)", "(Peter (nested))", "(a, b)", "(Eastern)", "(Newfoundland Time)"
+    , "(te \\( (HEU12) st)", "(\r\n )", "(\r)", "(A wonderful \\) chap)", "(his account)", "(Chris's host.)"
+    , "\r\n\t(comment)\r\n", "(", ")", "()", "(()", "(\\"
+    };
+
+  char const * const domain_literals[] =
+    { "[127\r\n  .0\r\n\t.0.1]", "[127\r\n  .0\r\n.0.1]", "[1.2.3.4]", "[192.168.0.1]", "[1.2\r\n .3]"
+    , "[127.0.0.1]", "[]", "[\\]]", "[", "[[]"
+    };
+
+  char const * const dates[] =
+    { "12  \r\n (te \\( (HEU12) st) (\r\n )\t JUN \t 82"
+    , "12 jUN 1982", "1 jAN 1970", "31 dec 1969 23:59:59"
+    , "31 dec 99999999999999999999999999999999999999999"
+    , "Thu, 4 Sep 1973 14:12:17", "Tho, 4 Sep 1973 14:12", "Thu, 31 Sep 1973 14:12", "Thu, 31 (\r)Sep 1973 14:12"
+    , "Thu, 1 Aug 2002 12:34:55 -1234", "17 Mar 2017 00:00:13 +1234", "17 Mar 2017 00:00:13 1234"
+    , "1 Jan 2000 00:00:00 Ut", "1 Jan 2000 00:00:00 GmT", "1 Jan 2000 00:00:00 est", "1 Jan 2000 00:00:00 edt"
+    , "1 Jan 2000 00:00:00 cst", "1 Jan 2000 00:00:00 pdt", "1 Jan 2000 00:00:00 Z", "1 Jan 2000 00:00:00 m"
+    , "1 Jan 2000 00:00:00 Y", "29 Feb 2400 23:59:59 +0000"
+    , "Thu, 04 Sep 1973 14:12:17 +0100", "4 sEP 1973 14:12:17 -0100", "Thu, 04 Sep 1899 14:12:17 +0100"
+    , "thu, 4 sep 73 14:12 EST (Eastern)", "Fri, 21 Nov 1997 09:55:06 -0600", "21 Nov 97 09:55:06 GMT"
+    , "Thu,\r\n\t13\r\n\t  Feb\r\n\t    1969\r\n\t23:32\r\n\t\t -0330 (Newfoundland Time)"
+    };
+
+  template <std::size_t N>
+  std::vector<std::string> seeds(char const * const (&inputs)[N])
+  {
+    return std::vector<std::string>(inputs, inputs + N);
+  }
+}
+
+std::vector<std::string> fuzz::address_seeds()        { return seeds(addresses); }
+std::vector<std::string> fuzz::comment_seeds()        { return seeds(comments); }
+std::vector<std::string> fuzz::domain_literal_seeds() { return seeds(domain_literals); }
+std::vector<std::string> fuzz::date_seeds()           { return seeds(dates); }
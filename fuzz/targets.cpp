@@ -0,0 +1,386 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "fuzz.hpp"
+#include "reference.hpp"
+#include "rfc2822/address.hpp"
+#include "rfc2822/address-interned.hpp"
+#include "rfc2822/address-ref.hpp"
+#include "rfc2822/address-view.hpp"
+#include "rfc2822/budget.hpp"
+#include "rfc2822/comment.hpp"
+#include "rfc2822/date.hpp"
+#include "rfc2822/parse.hpp"
+#include "rfc2822/prefilter.hpp"
+#include "rfc2822/recognize.hpp"
+#include "rfc2822/skipper.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+using namespace rfc2822;
+using fuzz::target;
+
+namespace
+{
+  fuzz::reference_addr_spec_parser const        reference_addr_spec_p;
+  fuzz::reference_route_addr_parser const       reference_route_addr_p;
+  fuzz::reference_mailbox_parser const          reference_mailbox_p;
+  fuzz::reference_comment_parser const          reference_comment_p;
+  date_parser const                             reference_date_p(false);
+
+  basic_addr_spec_parser<arena_string> const            arena_addr_spec_p;
+  basic_mailbox_parser<arena_string> const              arena_mailbox_p;
+  basic_route_addr_parser<arena_string> const           arena_route_addr_p;
+  basic_domain_literal_parser<arena_string> const       arena_domain_literal_p;
+
+  // Shared by all inputs, so that most lookups find a domain entered earlier.
+
+  domain_table interned_domains;
+
+  // The reference comment grammar recurses once per nesting level, so
+  // deeper input would only find out how large the stack is.
+
+  std::size_t const max_reference_depth = 1000u;
+
+  std::size_t nesting_depth(char const * first, char const * last)
+  {
+    std::size_t depth( 0u ), max_depth( 0u );
+    for (; first != last; ++first)
+      if (*first == '(' && ++depth > max_depth)
+        max_depth = depth;
+      else if (*first == ')' && depth)
+        --depth;
+    return max_depth;
+  }
+
+  inline bool same(std::string const & a, std::string const & b)    { return a == b; }
+  inline bool same(std::string const & a, arena_string const & b)   { return a.size() == b.size() && a.compare(0u, a.size(), b.data(), b.size()) == 0; }
+  inline bool same(std::string const & a, canonic_string const & b) { return b == a; }
+  inline bool same(spirit::nil_t, spirit::nil_t)                    { return true; }
+
+  inline bool same(timestamp const & a, timestamp const & b)
+  {
+    return a.tm_wday == b.tm_wday && a.tm_mday == b.tm_mday && a.tm_mon == b.tm_mon && a.tm_year == b.tm_year
+        && a.tm_hour == b.tm_hour && a.tm_min  == b.tm_min  && a.tm_sec == b.tm_sec && a.tzoffset == b.tzoffset;
+  }
+
+  /// \c true if \p id stands for \p domain in interned_domains.
+  bool same_domain(std::string const & domain, domain_id id)
+  {
+    std::string folded( domain );
+    for (std::string::iterator i = folded.begin(); i != folded.end(); ++i)
+      *i = domain_table::fold(*i);
+    return id != domain_table::no_domain && interned_domains.name(id) == folded;
+  }
+
+  template <typename ParserT, typename ResultT>
+  char const * run(ParserT const & p, char const * first, char const * last, ResultT & result)
+  {
+    spirit::parse_info<> const r( spirit::parse(first, last, p [spirit::assign_a(result)], skipper_p) );
+    return r.hit ? r.stop : 0;
+  }
+
+  template <typename ParserT>
+  char const * run(ParserT const & p, char const * first, char const * last, spirit::nil_t &)
+  {
+    spirit::parse_info<> const r( spirit::parse(first, last, p, skipper_p) );
+    return r.hit ? r.stop : 0;
+  }
+
+  template <typename ParserT, typename ResultT>
+  char const * run_bounded(ParserT const & p, char const * first, char const * last, ResultT & result, parse_budget & budget)
+  {
+    bounded_parse_info<> const r( bounded_parse(first, last, p [spirit::assign_a(result)], skipper_p, budget) );
+    return r.hit ? r.stop : 0;
+  }
+
+  template <typename ParserT>
+  char const * run_bounded(ParserT const & p, char const * first, char const * last, spirit::nil_t &, parse_budget & budget)
+  {
+    bounded_parse_info<> const r( bounded_parse(first, last, p, skipper_p, budget) );
+    return r.hit ? r.stop : 0;
+  }
+
+  /**
+   *  Compare \p p against its result from an ordinary parse. With unlimited
+   *  budget, a bounded parse must do exactly the same; with one step less
+   *  than that took, it must report that the budget was exceeded.
+   */
+  template <typename ParserT, typename ResultT>
+  void check_bounded( char const * name, ParserT const & p, char const * first, char const * last
+                    , char const * stop, ResultT const & expected
+                    )
+  {
+    ResultT result;
+    parse_budget unlimited;
+    RFC2822_FUZZ_CHECK(name, run_bounded(p, first, last, result, unlimited) == stop, first, last);
+    RFC2822_FUZZ_CHECK(name, !unlimited.exceeded, first, last);
+    if (stop) RFC2822_FUZZ_CHECK(name, same(expected, result), first, last);
+
+    if (unlimited.steps)
+    {
+      parse_budget tight(unlimited.steps - 1u);
+      RFC2822_FUZZ_CHECK(name, !run_bounded(p, first, last, result, tight), first, last);
+      RFC2822_FUZZ_CHECK(name, tight.exceeded, first, last);
+    }
+  }
+
+  void check_addr_spec(char const * first, char const * last)
+  {
+    char const * const name = "addr_spec";
+    std::string expected, result;
+    char const * const stop = run(addr_spec_p, first, last, result);
+    RFC2822_FUZZ_CHECK(name, run(reference_addr_spec_p, first, last, expected) == stop, first, last);
+    if (stop) RFC2822_FUZZ_CHECK(name, result == expected, first, last);
+
+    // The pre-filter must never reject what the grammar accepts.
+
+    if (stop) RFC2822_FUZZ_CHECK(name, may_be_addr_spec(first, last), first, last);
+
+    RFC2822_FUZZ_CHECK(name, recognize_addr_spec(first, last) == stop, first, last);
+
+    std::string precompiled;
+    RFC2822_FUZZ_CHECK(name, parse_addr_spec(first, last, precompiled) == stop, first, last);
+    if (stop) RFC2822_FUZZ_CHECK(name, precompiled == result, first, last);
+
+    canonic_string ref;
+    RFC2822_FUZZ_CHECK(name, run(addr_spec_ref_p, first, last, ref) == stop, first, last);
+    if (stop) RFC2822_FUZZ_CHECK(name, same(result, ref), first, last);
+
+    mailbox_view<> view;
+    RFC2822_FUZZ_CHECK(name, run(addr_spec_view_p, first, last, view) == stop, first, last);
+    if (stop) RFC2822_FUZZ_CHECK(name, view.canonic_addr_spec() == result, first, last);
+
+    interned_addr_spec interned;
+    RFC2822_FUZZ_CHECK(name, run(interned_addr_spec_p(interned_domains), first, last, interned) == stop, first, last);
+    if (stop) RFC2822_FUZZ_CHECK(name, interned.local_part == view.local_part, first, last);
+    if (stop) RFC2822_FUZZ_CHECK(name, same_domain(view.canonic_domain(), interned.domain), first, last);
+
+    arena_string arena;
+    RFC2822_FUZZ_CHECK(name, run(arena_addr_spec_p, first, last, arena) == stop, first, last);
+    if (stop) RFC2822_FUZZ_CHECK(name, same(result, arena), first, last);
+
+    // The fast path must not match where the grammar would match more.
+
+    spirit::parse_info<> const simple( spirit::parse(first, last, simple_addr_spec_p) );
+    if (simple.hit)
+    {
+      spirit::parse_info<> const full( spirit::parse(first, last, reference_addr_spec_p [spirit::assign_a(expected)]) );
+      RFC2822_FUZZ_CHECK(name, full.hit && full.stop == simple.stop, first, last);
+      RFC2822_FUZZ_CHECK(name, expected == std::string(first, simple.stop), first, last);
+    }
+
+    check_bounded(name, addr_spec_p, first, last, stop, result);
+  }
+
+  void check_mailbox(char const * first, char const * last)
+  {
+    char const * const name = "mailbox";
+    std::string expected, result;
+    char const * const stop = run(mailbox_p, first, last, result);
+    RFC2822_FUZZ_CHECK(name, run(reference_mailbox_p, first, last, expected) == stop, first, last);
+    if (stop) RFC2822_FUZZ_CHECK(name, result == expected, first, last);
+
+    RFC2822_FUZZ_CHECK(name, recognize_mailbox(first, last) == stop, first, last);
+
+    std::string precompiled;
+    RFC2822_FUZZ_CHECK(name, parse_mailbox(first, last, precompiled) == stop, first, last);
+    if (stop) RFC2822_FUZZ_CHECK(name, precompiled == result, first, last);
+
+    canonic_string ref;
+    RFC2822_FUZZ_CHECK(name, run(mailbox_ref_p, first, last, ref) == stop, first, last);
+    if (stop) RFC2822_FUZZ_CHECK(name, same(result, ref), first, last);
+
+    mailbox_view<> view;
+    RFC2822_FUZZ_CHECK(name, run(mailbox_view_p, first, last, view) == stop, first, last);
+    if (stop)
+    {
+      std::string canonic( view.canonic_addr_spec() );
+      if (view.route_size)
+      {
+        std::string route;
+        for (std::size_t n = 0; n != view.route_size && n != mailbox_view<>::max_route_hops; ++n)
+          route += (n ? ",@" : "@") + view.canonic_route_hop(n);
+        canonic = route + ':' + canonic;
+      }
+      if (result[0] == '<') canonic = '<' + canonic + '>';
+      if (view.route_size <= mailbox_view<>::max_route_hops)
+        RFC2822_FUZZ_CHECK(name, canonic == result, first, last);
+    }
+
+    arena_string arena;
+    RFC2822_FUZZ_CHECK(name, run(arena_mailbox_p, first, last, arena) == stop, first, last);
+    if (stop) RFC2822_FUZZ_CHECK(name, same(result, arena), first, last);
+
+    check_bounded(name, mailbox_p, first, last, stop, result);
+  }
+
+  void check_route_addr(char const * first, char const * last)
+  {
+    char const * const name = "route_addr";
+    std::string expected, result;
+    char const * const stop = run(route_addr_p, first, last, result);
+    RFC2822_FUZZ_CHECK(name, run(reference_route_addr_p, first, last, expected) == stop, first, last);
+    if (stop) RFC2822_FUZZ_CHECK(name, result == expected, first, last);
+
+    RFC2822_FUZZ_CHECK(name, recognize_route_addr(first, last) == stop, first, last);
+
+    std::string precompiled;
+    RFC2822_FUZZ_CHECK(name, parse_route_addr(first, last, precompiled) == stop, first, last);
+    if (stop) RFC2822_FUZZ_CHECK(name, precompiled == result, first, last);
+
+    arena_string arena;
+    RFC2822_FUZZ_CHECK(name, run(arena_route_addr_p, first, last, arena) == stop, first, last);
+    if (stop) RFC2822_FUZZ_CHECK(name, same(result, arena), first, last);
+
+    check_bounded(name, route_addr_p, first, last, stop, result);
+  }
+
+  void check_domain_literal(char const * first, char const * last)
+  {
+    char const * const name = "domain_literal";
+    std::string result;
+    char const * const stop = run(domain_literal_p, first, last, result);
+    RFC2822_FUZZ_CHECK(name, recognize(domain_literal_p, first, last) == stop, first, last);
+
+    arena_string arena;
+    RFC2822_FUZZ_CHECK(name, run(arena_domain_literal_p, first, last, arena) == stop, first, last);
+    if (stop) RFC2822_FUZZ_CHECK(name, same(result, arena), first, last);
+
+    check_bounded(name, domain_literal_p, first, last, stop, result);
+  }
+
+  void check_comment(char const * first, char const * last)
+  {
+    char const * const name = "comment";
+    spirit::nil_t nil;
+    char const * const stop = run(comment_p, first, last, nil);
+    if (nesting_depth(first, last) <= max_reference_depth)
+    {
+      RFC2822_FUZZ_CHECK(name, run(reference_comment_p, first, last, nil) == stop, first, last);
+      spirit::parse_info<> const r1( spirit::parse(first, last, comment_p) );
+      spirit::parse_info<> const r2( spirit::parse(first, last, reference_comment_p) );
+      RFC2822_FUZZ_CHECK(name, r1.hit == r2.hit && (!r1.hit || r1.stop == r2.stop), first, last);
+    }
+
+    check_bounded(name, comment_p, first, last, stop, nil);
+
+    // Nesting one level deeper than the budget allows must exceed it.
+
+    std::size_t const depth( nesting_depth(first, stop ? stop : first) );
+    if (depth)
+    {
+      parse_budget shallow(parse_budget().max_steps, depth - 1u);
+      RFC2822_FUZZ_CHECK(name, !run_bounded(comment_p, first, last, nil, shallow), first, last);
+      RFC2822_FUZZ_CHECK(name, shallow.exceeded, first, last);
+    }
+  }
+
+  void check_date(char const * first, char const * last)
+  {
+    char const * const name = "date";
+    timestamp expected, result;
+    char const * const stop = run(date_p, first, last, result);
+    RFC2822_FUZZ_CHECK(name, run(reference_date_p, first, last, expected) == stop, first, last);
+    if (stop) RFC2822_FUZZ_CHECK(name, same(result, expected), first, last);
+
+    RFC2822_FUZZ_CHECK(name, recognize_date(first, last) == stop, first, last);
+
+    timestamp precompiled;
+    RFC2822_FUZZ_CHECK(name, parse_date(first, last, precompiled) == stop, first, last);
+    if (stop) RFC2822_FUZZ_CHECK(name, same(result, precompiled), first, last);
+
+    // Like simple_addr_spec_p, the fast path must not match where the
+    // grammar would match more.
+
+    timestamp fixed;
+    char const * const fixed_stop = run(fixed_date_p, first, last, fixed);
+    if (fixed_stop)
+    {
+      RFC2822_FUZZ_CHECK(name, fixed_stop == stop, first, last);
+      RFC2822_FUZZ_CHECK(name, same(fixed, expected), first, last);
+    }
+
+    check_bounded(name, date_p, first, last, stop, result);
+  }
+
+  char const * recognize_domain_literal(char const * first, char const * last) { return recognize(domain_literal_p, first, last); }
+  char const * recognize_comment(char const * first, char const * last)        { return recognize(comment_p, first, last); }
+
+  target make_target(char const * name, fuzz::parse_function parse, fuzz::check_function check, std::vector<std::string> const & seeds)
+  {
+    target t;
+    t.name  = name;
+    t.parse = parse;
+    t.check = check;
+    t.seeds = seeds;
+    return t;
+  }
+}
+
+std::vector<target> const & fuzz::targets()
+{
+  static std::vector<target> all;
+  if (all.empty())
+  {
+    all.push_back(make_target("addr_spec",      &recognize_addr_spec,      &check_addr_spec,      fuzz::address_seeds()));
+    all.push_back(make_target("mailbox",        &recognize_mailbox,        &check_mailbox,        fuzz::address_seeds()));
+    all.push_back(make_target("route_addr",     &recognize_route_addr,     &check_route_addr,     fuzz::address_seeds()));
+    all.push_back(make_target("domain_literal", &recognize_domain_literal, &check_domain_literal, fuzz::domain_literal_seeds()));
+    all.push_back(make_target("comment",        &recognize_comment,        &check_comment,        fuzz::comment_seeds()));
+    all.push_back(make_target("date",           &recognize_date,           &check_date,           fuzz::date_seeds()));
+  }
+  return all;
+}
+
+target const * fuzz::find_target(std::string const & name)
+{
+  std::vector<target> const & all( targets() );
+  for (std::size_t i = 0; i != all.size(); ++i)
+    if (name == all[i].name)
+      return &all[i];
+  return 0;
+}
+
+std::string fuzz::quote(char const * first, char const * last)
+{
+  std::string r( "\"" );
+  for (; first != last; ++first)
+  {
+    unsigned char const c( static_cast<unsigned char>(*first) );
+    char buf[8];
+    switch (c)
+    {
+      case '"':  r += "\\\""; break;
+      case '\\': r += "\\\\"; break;
+      case '\r': r += "\\r";  break;
+      case '\n': r += "\\n";  break;
+      case '\t': r += "\\t";  break;
+      default:
+        if (c < 0x20 || c >= 0x7f)
+        {
+          std::sprintf(buf, "\\x%02x\"\"", c);
+          r += buf;
+        }
+        else
+          r += static_cast<char>(c);
+    }
+  }
+  return r + '"';
+}
+
+void fuzz::failure(char const * target, char const * what, char const * first, char const * last)
+{
+  std::string const input( quote(first, last) );
+  std::fprintf(stderr, "%s: check failed: %s\n  input: %s\n", target, what, input.c_str());
+  std::abort();
+}
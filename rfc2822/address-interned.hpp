@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_ADDRESS_INTERNED_HPP_INCLUDED
+#define RFC2822_ADDRESS_INTERNED_HPP_INCLUDED
+
+#include "address.hpp"
+#include "domain-table.hpp"
+#include <boost/range/iterator_range.hpp>
+
+namespace rfc2822
+{
+  namespace detail
+  {
+    /**
+     *  The end of the <code>dot-atom-text</code> at \p first, or \p first
+     *  if there is none. The text ends before a trailing dot. Unless \p h
+     *  is \c NULL, it is advanced over the text with domain_table::hash_step().
+     */
+    inline char const * dot_atom_end(char const * first, char const * last, boost::uint64_t * h)
+    {
+      char const * end( first );
+      boost::uint64_t hash( h ? *h : 0u );
+      for (char const * p = first; p != last; ++p)
+      {
+        char const c( *p );
+        if (char_class_table[static_cast<unsigned char>(c)] & atext_class)
+          end = p + 1;
+        else if (c != '.' || end != p || p == first)
+          break;
+        if (h)
+        {
+          hash = domain_table::hash_step(hash, c);
+          if (end == p + 1)
+            *h = hash;
+        }
+      }
+      return end;
+    }
+
+    struct note_action
+    {
+      bool * ran;
+      explicit note_action(bool & r) : ran(&r) { }
+      template <typename IteratorT>
+      void operator() (IteratorT, IteratorT) const { *ran = true; }
+    };
+
+    /// \c false if \p scan doesn't run semantic actions, as under
+    /// <code>no_actions_d</code>. The scanner stays where it is.
+    template <typename ScannerT>
+    inline bool runs_actions(ScannerT const & scan)
+    {
+      typename ScannerT::iterator_t const save(scan.first);
+      bool ran( false );
+      spirit::eps_p[note_action(ran)].parse(scan);     // which runs the skipper
+      scan.first = save;
+      return ran;
+    }
+
+    /// \c true if the grammar might take the text starting at \p c as more of
+    /// a dot-atom: a dot, or white space or a comment in front of one.
+    inline bool may_continue_dot_atom(char c)
+    {
+      return c == '.' || c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '(';
+    }
+  }
+
+  /**
+   *  Match a domain like domain_p and return its ID in a \c domain_table,
+   *  entering the domain if it's new. Use interned_domain_p to create one.
+   *  Under <code>no_actions_d</code>, as in recognizers and lookahead,
+   *  nothing is entered; the result is the ID of a plain domain that is
+   *  in the table already, and \c no_domain otherwise.
+   *
+   *  A plain <code>dot-atom-text</code> is validated, case-folded, and
+   *  hashed in a single pass over the input, and looked up without
+   *  building a string. Anything else -- comments, folding white space,
+   *  domain literals -- goes through domain_p, and its canonic result is
+   *  interned. Works on <code>char const *</code> ranges only.
+   */
+  struct interned_domain_parser : public spirit::parser<interned_domain_parser>
+  {
+    typedef interned_domain_parser self_t;
+
+    template <typename ScannerT>
+    struct result
+    {
+      typedef typename spirit::match_result<ScannerT, domain_id>::type type;
+    };
+
+    domain_table & table;
+
+    explicit interned_domain_parser(domain_table & t) : table(t) { }
+
+    template <typename ScannerT>
+    typename spirit::parser_result<self_t, ScannerT>::type
+    parse(ScannerT const & scan) const
+    {
+      if (scan.at_end())        // also gives the skipper a chance to run
+        return scan.no_match();
+      char const * const first( scan.first );
+      boost::uint64_t h( domain_table::hash_seed );
+      char const * const end( detail::dot_atom_end(first, budget_end(scan), &h) );
+      if (end != first && (end == scan.last || !detail::may_continue_dot_atom(*end)))
+      {
+        std::size_t const len( static_cast<std::size_t>(end - first) );
+        if (!charge(scan, len))
+          return scan.no_match();
+        scan.first = end;
+        domain_id id( table.find(first, end, h) );
+        if (!id && detail::runs_actions(scan))
+          id = table.intern(first, end, h);
+        return scan.create_match(len, id, first, end);
+      }
+
+      std::string name;
+      if (!domain_p [spirit::assign_a(name)].parse(scan))
+        return scan.no_match();
+      domain_id const id( detail::runs_actions(scan) ? table.intern(name.data(), name.data() + name.size())
+                                                     : domain_table::no_domain );
+      return scan.create_match(static_cast<std::size_t>(scan.first - first), id, first, scan.first);
+    }
+  };
+
+  struct interned_domain_parser_gen
+  {
+    interned_domain_parser_gen() { }
+
+    interned_domain_parser operator() (domain_table & table) const
+    {
+      return interned_domain_parser(table);
+    }
+  };
+
+  /// The result of interned_addr_spec_p.
+  struct interned_addr_spec
+  {
+    typedef boost::iterator_range<char const *> range_type;
+
+    range_type  local_part;     ///< The raw text, as in mailbox_view.
+    domain_id   domain;
+
+    interned_addr_spec() : domain(domain_table::no_domain) { }
+  };
+
+  /**
+   *  Match an addr-spec like addr_spec_p and return the local part as it
+   *  stands in the input, along with the ID of the domain. Use
+   *  interned_addr_spec_p to create one. A <code>dot-atom-text</code>
+   *  local part right in front of the "@" is taken in a single pass;
+   *  otherwise, local_part_p checks it. Works on <code>char const
+   *  *</code> ranges only.
+   */
+  struct interned_addr_spec_parser : public spirit::parser<interned_addr_spec_parser>
+  {
+    typedef interned_addr_spec_parser self_t;
+
+    template <typename ScannerT>
+    struct result
+    {
+      typedef typename spirit::match_result<ScannerT, interned_addr_spec>::type type;
+    };
+
+    domain_table & table;
+
+    explicit interned_addr_spec_parser(domain_table & t) : table(t) { }
+
+    template <typename ScannerT>
+    typename spirit::parser_result<self_t, ScannerT>::type
+    parse(ScannerT const & scan) const
+    {
+      if (scan.at_end())
+        return scan.no_match();
+      char const * const first( scan.first );
+      char const * const end( detail::dot_atom_end(first, budget_end(scan), 0) );
+      if (end != first && end != scan.last && *end == '@')
+      {
+        if (!charge(scan, static_cast<std::size_t>(end - first)))
+          return scan.no_match();
+        scan.first = end;
+      }
+      else if (!spirit::no_actions_d[local_part_p].parse(scan))
+        return scan.no_match();
+
+      interned_addr_spec result;
+      result.local_part = interned_addr_spec::range_type(first, scan.first);
+      if (!spirit::ch_p('@').parse(scan))
+        return scan.no_match();
+      typename spirit::match_result<ScannerT, domain_id>::type const domain( interned_domain_parser(table).parse(scan) );
+      if (!domain)
+        return scan.no_match();
+      result.domain = domain.value();
+      return scan.create_match(static_cast<std::size_t>(scan.first - first), result, first, scan.first);
+    }
+  };
+
+  struct interned_addr_spec_parser_gen
+  {
+    interned_addr_spec_parser_gen() { }
+
+    interned_addr_spec_parser operator() (domain_table & table) const
+    {
+      return interned_addr_spec_parser(table);
+    }
+  };
+
+} // rfc2822
+
+#endif // RFC2822_ADDRESS_INTERNED_HPP_INCLUDED
@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_ADDRESS_LIST_HPP_INCLUDED
+#define RFC2822_ADDRESS_LIST_HPP_INCLUDED
+
+#include "address-view.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace rfc2822
+{
+  namespace detail
+  {
+    /// Pass a parsed mailbox on to the visitor, tagged with its group.
+    template <typename VisitorT>
+    struct visit_mailbox
+    {
+      typedef mailbox_view<>::range_type range_type;
+
+      VisitorT const &          visitor;
+      range_type const &        group;
+
+      visit_mailbox(VisitorT const & v, range_type const & g) : visitor(v), group(g) { }
+
+      void operator() (mailbox_view<> const & m) const
+      {
+        if (group.empty())
+          visitor(m);
+        else
+        {
+          mailbox_view<> v(m);
+          v.group = group;
+          visitor(v);
+        }
+      }
+    };
+
+    /**
+     *  <code>1*([item] ",") [item]</code> with at least one item, i.e. the
+     *  obsolete list syntax, which allows empty elements.
+     */
+    template <typename ItemT>
+    struct obs_list_parser : public spirit::parser< obs_list_parser<ItemT> >
+    {
+      typedef obs_list_parser<ItemT> self_t;
+
+      ItemT const item;
+
+      explicit obs_list_parser(ItemT const & i) : item(i) { }
+
+      template <typename ScannerT>
+      typename spirit::parser_result<self_t, ScannerT>::type
+      parse(ScannerT const & scan) const
+      {
+        using namespace spirit;
+        return ( *ch_p(',') >> item >> *( +ch_p(',') >> item ) >> *ch_p(',') ).parse(scan);
+      }
+    };
+
+    template <typename ItemT>
+    inline obs_list_parser<ItemT> obs_list(ItemT const & item)
+    {
+      return obs_list_parser<ItemT>(item);
+    }
+
+    /// <code>display-name ":" [mailbox-list] ";"</code>
+    template <typename VisitorT>
+    struct group_parser : public spirit::parser< group_parser<VisitorT> >
+    {
+      typedef group_parser<VisitorT>      self_t;
+      typedef mailbox_view<>::range_type  range_type;
+
+      VisitorT const & visitor;
+
+      explicit group_parser(VisitorT const & v) : visitor(v) { }
+
+      template <typename ScannerT>
+      typename spirit::parser_result<self_t, ScannerT>::type
+      parse(ScannerT const & scan) const
+      {
+        using namespace spirit;
+        range_type name;
+        visit_mailbox<VisitorT> const visit(visitor, name);
+        return ( (word_p >> *( word_p | '.' )) [assign_a(name)]
+                 >> ':'
+                 >> !obs_list( mailbox_view_p [visit] )
+                 >> ';'
+               ).parse(scan);
+      }
+    };
+  }
+
+  /**
+   *  Match a <code>mailbox-list</code> and call a visitor for every mailbox
+   *  in it. Use mailbox_list_p to create one.
+   *
+   *  The visitor is copied and called as <code>visitor(m)</code>, where
+   *  \c m is a <code>mailbox_view<> const &</code> that is valid for the
+   *  duration of the call only. Nothing is stored between mailboxes, so a
+   *  list is parsed in one pass and without allocating memory, no matter
+   *  how long it is.
+   *
+   *  Mailboxes are reported as soon as they have been parsed. When the
+   *  parser stops early, the visitor has seen exactly the mailboxes in the
+   *  part of the input that was consumed.
+   */
+  template <typename VisitorT>
+  struct mailbox_list_parser : public spirit::parser< mailbox_list_parser<VisitorT> >
+  {
+    typedef mailbox_list_parser<VisitorT> self_t;
+    typedef mailbox_view<>::range_type    range_type;
+
+    VisitorT const visitor;
+
+    explicit mailbox_list_parser(VisitorT const & v) : visitor(v) { }
+
+    template <typename ScannerT>
+    typename spirit::parser_result<self_t, ScannerT>::type
+    parse(ScannerT const & scan) const
+    {
+      range_type const none;
+      detail::visit_mailbox<VisitorT> const visit(visitor, none);
+      return detail::obs_list( mailbox_view_p [visit] ).parse(scan);
+    }
+  };
+
+  /**
+   *  Match an <code>address-list</code> and call a visitor for every
+   *  mailbox in it, including the members of groups. Use address_list_p to
+   *  create one.
+   *
+   *  Works like mailbox_list_parser; mailboxes that are members of a group
+   *  have mailbox_view::group set to the group's display name. Groups
+   *  without members aren't reported. A group's members are reported only
+   *  once the group is known to be complete, which takes a second pass
+   *  over the group.
+   */
+  template <typename VisitorT>
+  struct address_list_parser : public spirit::parser< address_list_parser<VisitorT> >
+  {
+    typedef address_list_parser<VisitorT> self_t;
+    typedef mailbox_view<>::range_type    range_type;
+
+    VisitorT const visitor;
+
+    explicit address_list_parser(VisitorT const & v) : visitor(v) { }
+
+    template <typename ScannerT>
+    typename spirit::parser_result<self_t, ScannerT>::type
+    parse(ScannerT const & scan) const
+    {
+      using namespace spirit;
+      range_type const none;
+      detail::visit_mailbox<VisitorT> const visit(visitor, none);
+      detail::group_parser<VisitorT> const group(visitor);
+      return detail::obs_list
+        (  mailbox_view_p [visit]
+        |  eps_p(no_actions_d[group]) >> group
+        ).parse(scan);
+    }
+  };
+
+  struct mailbox_list_parser_gen
+  {
+    mailbox_list_parser_gen() { }
+
+    template <typename VisitorT>
+    mailbox_list_parser<VisitorT> operator() (VisitorT const & visitor) const
+    {
+      return mailbox_list_parser<VisitorT>(visitor);
+    }
+  };
+
+  struct address_list_parser_gen
+  {
+    address_list_parser_gen() { }
+
+    template <typename VisitorT>
+    address_list_parser<VisitorT> operator() (VisitorT const & visitor) const
+    {
+      return address_list_parser<VisitorT>(visitor);
+    }
+  };
+
+  /**
+   *  \brief Find the commas that separate the elements of an address list.
+   *
+   *  Commas inside quoted strings, comments, domain literals, angle
+   *  brackets, and groups don't count. The input is scanned sixteen bytes
+   *  at a time for the characters that open or close one of those; only
+   *  these are looked at one by one. Every comma found is appended to
+   *  \p commas.
+   *
+   *  \return \c false if the nesting isn't balanced, in which case the
+   *          input isn't an address-list.
+   */
+  bool split_address_list(char const * first, char const * last, std::vector<char const *> & commas);
+
+  struct address_list_options
+  {
+    unsigned            threads;        ///< 0 means one per CPU.
+    std::size_t         min_chunk;      ///< No thread gets less than this many bytes of input.
+
+    address_list_options() : threads(0u), min_chunk(64u * 1024u) { }
+  };
+
+  /**
+   *  \brief Parse an address-list into the canonic mailboxes mailbox_p
+   *         produces.
+   *
+   *  The members of groups are included; the group names are dropped. The
+   *  result is the same as that of parsing the list in one go, but long
+   *  lists are split with split_address_list() and the pieces are parsed
+   *  by a pool of threads. Input that can't be split, or a piece that
+   *  doesn't parse on its own, makes it fall back to parsing in one go.
+   *  The pool is started on first use and kept for the lifetime of the
+   *  program; parse_mbox() shares it.
+   *
+   *  Unless the library was built thread-safe, i.e. with
+   *  BOOST_SPIRIT_THREADSAFE, the list is always parsed in one go.
+   *
+   *  \return \c true if the whole input is an address-list, in which case
+   *          the mailboxes have been appended to \p result. Otherwise
+   *          \p result is left alone.
+   */
+  bool parse_address_list( char const * first, char const * last
+                         , std::vector<std::string> & result
+                         , address_list_options const & opt = address_list_options()
+                         );
+
+} // rfc2822
+
+#endif // RFC2822_ADDRESS_LIST_HPP_INCLUDED
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_ADDRESS_REF_HPP_INCLUDED
+#define RFC2822_ADDRESS_REF_HPP_INCLUDED
+
+#include "address.hpp"
+#include "canonic-string.hpp"
+#include <boost/spirit/include/phoenix1_functions.hpp>
+
+namespace rfc2822
+{
+  struct canonic_string_closure : public spirit::closure<canonic_string_closure, canonic_string>
+  {
+    member1 val;
+  };
+
+  /// Designate a match that is canonic as it stands.
+  struct assign_slice_impl
+  {
+    template <typename StringT, typename IteratorT1, typename IteratorT2>
+    struct result
+    {
+      typedef void type;
+    };
+
+    void operator() (canonic_string & s, char const * first, char const * last) const
+    {
+      s.assign(first, last);
+    }
+  };
+  phoenix::function<assign_slice_impl> const assign_slice = assign_slice_impl();
+
+  /// Store the result of one of the string-building parsers.
+  struct assign_canonic_impl
+  {
+    template <typename StringT1, typename StringT2>
+    struct result
+    {
+      typedef void type;
+    };
+
+    void operator() (canonic_string & s, std::string const & canonic) const
+    {
+      s.assign(canonic);
+    }
+  };
+  phoenix::function<assign_canonic_impl> const assign_canonic = assign_canonic_impl();
+
+  // Only input that the single-pass scanners accept -- a bare dot-atom
+  // addr-spec, possibly in angle brackets -- is taken as canonic. Anything
+  // else goes to the string-building parsers, which start over.
+
+  struct addr_spec_ref_parser : public spirit::grammar<addr_spec_ref_parser, canonic_string_closure::context_t>
+  {
+    addr_spec_ref_parser() { }
+
+    template<typename scannerT>
+    struct definition
+    {
+      spirit::rule<scannerT, rule_context> addr_spec;
+
+      definition(addr_spec_ref_parser const & self)
+      {
+        using namespace spirit;
+        using namespace phoenix;
+
+        addr_spec
+          = simple_addr_spec_p  [assign_slice(self.val, arg1, arg2)]
+          | addr_spec_p         [assign_canonic(self.val, arg1)]
+          ;
+
+        RFC2822_DEBUG_NODE(addr_spec);
+      }
+
+      spirit::rule<scannerT, rule_context> const & start() const { return addr_spec; }
+    };
+  };
+
+  struct mailbox_ref_parser : public spirit::grammar<mailbox_ref_parser, canonic_string_closure::context_t>
+  {
+    mailbox_ref_parser() { }
+
+    template<typename scannerT>
+    struct definition
+    {
+      spirit::rule<scannerT, rule_context> mailbox;
+      spirit::rule<scannerT, rule_context> phrase_tail;
+      spirit::rule<scannerT, rule_context> route_addr;
+
+      definition(mailbox_ref_parser const & self)
+      {
+        using namespace spirit;
+        using namespace phoenix;
+
+        // The same single pass as mailbox_p. The display name isn't part
+        // of the result, so skipping it doesn't make the route-addr after
+        // it any less canonic.
+
+        mailbox
+          = simple_addr_spec_p  [assign_slice(self.val, arg1, arg2)]
+          | route_addr
+          | detail::shared_prefix
+            (  local_part_p
+            ,  ch_p('@')
+            ,  addr_spec_p      [assign_canonic(self.val, arg1)]
+            ,  phrase_tail >> route_addr
+            )
+          ;
+
+        phrase_tail = *( word_p | '.' );
+
+        route_addr
+          = lexeme_d[ '<' >> simple_addr_spec_p >> '>' ]
+                                [assign_slice(self.val, arg1, arg2)]
+          | route_addr_p        [assign_canonic(self.val, arg1)]
+          ;
+
+        RFC2822_DEBUG_NODE(mailbox);
+        RFC2822_DEBUG_NODE(phrase_tail);
+        RFC2822_DEBUG_NODE(route_addr);
+      }
+
+      spirit::rule<scannerT, rule_context> const & start() const { return mailbox; }
+    };
+  };
+
+} // rfc2822
+
+#endif // RFC2822_ADDRESS_REF_HPP_INCLUDED
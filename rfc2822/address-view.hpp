@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_ADDRESS_VIEW_HPP_INCLUDED
+#define RFC2822_ADDRESS_VIEW_HPP_INCLUDED
+
+#include "address.hpp"
+#include "skipper.hpp"
+#include <algorithm>
+#include <boost/assert.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <boost/spirit/include/phoenix1_binders.hpp>
+
+namespace rfc2822
+{
+  /**
+   *  The parts of a mailbox as ranges into the parsed input. All ranges
+   *  designate the raw text, i.e. they may contain comments, quoted pairs,
+   *  and folding white space; use the <code>canonic_*()</code> functions to
+   *  get the text addr_spec_p and friends would have produced. Parts that
+   *  don't occur in the input are empty.
+   */
+  template <typename IteratorT = char const *>
+  struct mailbox_view
+  {
+    typedef IteratorT                           iterator;
+    typedef boost::iterator_range<IteratorT>    range_type;
+
+    enum { max_route_hops = 8 };
+
+    range_type  display_name;
+    range_type  local_part;
+    range_type  domain;
+    range_type  route;                          ///< The complete obs-route, including the trailing colon.
+    range_type  route_hops[max_route_hops];     ///< The domain of every hop in the route.
+    std::size_t route_size;                     ///< Number of hops; only the first max_route_hops are stored.
+    range_type  group;                          ///< Display name of the group the mailbox is a member of; set by address_list_p only.
+
+    mailbox_view() : route_size(0u) { }
+
+    void push_route_hop(range_type const & hop)
+    {
+      if (route_size < max_route_hops)
+        route_hops[route_size] = hop;
+      ++route_size;
+    }
+
+    std::string canonic_local_part() const { return canonic(local_part_p, local_part); }
+    std::string canonic_domain() const     { return canonic(domain_p, domain); }
+    std::string canonic_addr_spec() const  { return canonic_local_part() + '@' + canonic_domain(); }
+
+    std::string canonic_route_hop(std::size_t i) const
+    {
+      BOOST_ASSERT(i < route_size && i < max_route_hops);
+      return canonic(domain_p, route_hops[i]);
+    }
+
+  private:
+    template <typename ParserT>
+    static std::string canonic(ParserT const & p, range_type const & r)
+    {
+      std::string result;
+      spirit::parse(r.begin(), r.end(), p [spirit::assign_a(result)], skipper_p);
+      return result;
+    }
+  };
+
+  template <typename IteratorT>
+  struct mailbox_view_closure : public spirit::closure< mailbox_view_closure<IteratorT>, mailbox_view<IteratorT> >
+  {
+    typename mailbox_view_closure::member1 val;
+  };
+
+  PP_PHOENIX_DEFINE_RECORD_ACCESSOR(view_display_name, typename Record::range_type &, display_name);
+  PP_PHOENIX_DEFINE_RECORD_ACCESSOR(view_local_part,   typename Record::range_type &, local_part);
+  PP_PHOENIX_DEFINE_RECORD_ACCESSOR(view_domain,       typename Record::range_type &, domain);
+  PP_PHOENIX_DEFINE_RECORD_ACCESSOR(view_route,        typename Record::range_type &, route);
+
+  struct push_route_hop_impl
+  {
+    template <typename ViewT, typename IteratorT1, typename IteratorT2>
+    struct result
+    {
+      typedef void type;
+    };
+
+    template <typename ViewT, typename IteratorT>
+    void operator() (ViewT & v, IteratorT first, IteratorT last) const
+    {
+      v.push_route_hop(typename ViewT::range_type(first, last));
+    }
+  };
+  phoenix::function<push_route_hop_impl> const push_route_hop = push_route_hop_impl();
+
+  /// Split a match of simple_addr_spec_p at the "@".
+  struct split_addr_spec_impl
+  {
+    template <typename ViewT, typename IteratorT1, typename IteratorT2>
+    struct result
+    {
+      typedef void type;
+    };
+
+    template <typename ViewT, typename IteratorT>
+    void operator() (ViewT & v, IteratorT first, IteratorT last) const
+    {
+      IteratorT const at( std::find(first, last, '@') );
+      IteratorT domain( at );
+      v.local_part = typename ViewT::range_type(first, at);
+      v.domain     = typename ViewT::range_type(++domain, last);
+    }
+  };
+  phoenix::function<split_addr_spec_impl> const split_addr_spec = split_addr_spec_impl();
+
+  /// Copy only the addr-spec parts of a view.
+  struct assign_addr_spec_impl
+  {
+    template <typename ViewT1, typename ViewT2>
+    struct result
+    {
+      typedef void type;
+    };
+
+    template <typename ViewT>
+    void operator() (ViewT & v, ViewT const & addr_spec) const
+    {
+      v.local_part = addr_spec.local_part;
+      v.domain     = addr_spec.domain;
+    }
+  };
+  phoenix::function<assign_addr_spec_impl> const assign_addr_spec = assign_addr_spec_impl();
+
+  template <typename IteratorT>
+  struct addr_spec_view_parser
+    : public spirit::grammar< addr_spec_view_parser<IteratorT>, typename mailbox_view_closure<IteratorT>::context_t >
+  {
+    typedef boost::iterator_range<IteratorT> range_type;
+
+    addr_spec_view_parser() { }
+
+    template<typename scannerT>
+    struct definition
+    {
+      spirit::rule<scannerT, rule_context> addr_spec;
+      spirit::rule<scannerT, rule_context> local_part;
+      spirit::rule<scannerT, rule_context> domain;
+
+      definition(addr_spec_view_parser const & self)
+      {
+        using namespace spirit;
+        using namespace phoenix;
+
+        addr_spec
+          = simple_addr_spec_p [split_addr_spec(self.val, arg1, arg2)]
+          | local_part         [view_local_part(self.val) = construct_<range_type>(arg1, arg2)]
+            >> '@'
+            >> domain          [view_domain(self.val) = construct_<range_type>(arg1, arg2)]
+          ;
+
+        local_part  = no_actions_d[ local_part_p ];
+        domain      = no_actions_d[ domain_p ];
+
+        RFC2822_DEBUG_NODE(addr_spec);
+      }
+
+      spirit::rule<scannerT, rule_context> const & start() const { return addr_spec; }
+    };
+  };
+
+  template <typename IteratorT>
+  struct mailbox_view_parser
+    : public spirit::grammar< mailbox_view_parser<IteratorT>, typename mailbox_view_closure<IteratorT>::context_t >
+  {
+    typedef boost::iterator_range<IteratorT> range_type;
+
+    mailbox_view_parser() { }
+
+    template<typename scannerT>
+    struct definition
+    {
+      addr_spec_view_parser<IteratorT> const    addr_spec;
+      spirit::rule<scannerT, rule_context>      mailbox;
+      spirit::rule<scannerT, rule_context>      phrase;
+      spirit::rule<scannerT, rule_context>      route;
+      spirit::rule<scannerT, rule_context>      hop;
+      spirit::rule<scannerT, rule_context>      domain;
+
+      definition(mailbox_view_parser const & self)
+      {
+        using namespace spirit;
+        using namespace phoenix;
+
+        // Nothing that matches an addr-spec can match a name-addr, so
+        // trying the common case first doesn't change the language.
+
+        mailbox
+          = addr_spec           [assign_addr_spec(self.val, arg1)]
+          | !phrase             [view_display_name(self.val) = construct_<range_type>(arg1, arg2)]
+            >> '<'
+            >> !route           [view_route(self.val) = construct_<range_type>(arg1, arg2)]
+            >> addr_spec        [assign_addr_spec(self.val, arg1)]
+            >> '>'
+          ;
+
+        phrase  = word_p >> *( word_p | '.' );
+
+        route   = hop >> *( ',' >> hop ) >> ':';
+
+        hop     = '@' >> domain [push_route_hop(self.val, arg1, arg2)];
+
+        domain  = no_actions_d[ domain_p ];
+
+        RFC2822_DEBUG_NODE(mailbox);
+        RFC2822_DEBUG_NODE(phrase);
+        RFC2822_DEBUG_NODE(route);
+      }
+
+      spirit::rule<scannerT, rule_context> const & start() const { return mailbox; }
+    };
+  };
+
+} // rfc2822
+
+#endif // RFC2822_ADDRESS_VIEW_HPP_INCLUDED
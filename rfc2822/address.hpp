@@ -14,52 +14,172 @@
 #define RFC2822_ADDRESS_HPP_INCLUDED
 
 #include "word.hpp"
+#include "simple-addr-spec.hpp"
+#include "arena.hpp"
+#include <cstddef>
 #include <string>
 #include <boost/spirit/include/classic_closure.hpp>
+#include <boost/spirit/include/phoenix1_functions.hpp>
+#include <boost/spirit/include/phoenix1_statements.hpp>
 
 namespace rfc2822
 {
-  struct string_closure : public spirit::closure<string_closure, std::string>
+  // The address parsers build their results in a string of type StringT,
+  // which must behave like a std::basic_string<char>. Every string a
+  // closure holds is default-constructed, so an allocator that finds its
+  // memory pool on its own, like arena_allocator, serves them all.
+
+  template <typename StringT>
+  struct basic_string_closure : public spirit::closure< basic_string_closure<StringT>, StringT >
   {
-    member1 val;
+    typename basic_string_closure::member1 val;
   };
 
-  struct local_part_parser : public spirit::grammar<local_part_parser, string_closure::context_t>
+  typedef basic_string_closure<std::string> string_closure;
+
+  /// Append a matched range to a string without building a temporary.
+  struct append_range_impl
   {
-    local_part_parser() { }
+    template <typename StringT, typename IteratorT1, typename IteratorT2>
+    struct result
+    {
+      typedef void type;
+    };
+
+    template <typename StringT, typename IteratorT>
+    void operator() (StringT & s, IteratorT first, IteratorT last) const
+    {
+      s.append(first, last);
+    }
+  };
+  phoenix::function<append_range_impl> const append_range = append_range_impl();
+
+  /// Replace a string by a matched range.
+  struct assign_range_impl
+  {
+    template <typename StringT, typename IteratorT1, typename IteratorT2>
+    struct result
+    {
+      typedef void type;
+    };
+
+    template <typename StringT, typename IteratorT>
+    void operator() (StringT & s, IteratorT first, IteratorT last) const
+    {
+      s.assign(first, last);
+    }
+  };
+  phoenix::function<assign_range_impl> const assign_range = assign_range_impl();
+
+  namespace detail
+  {
+    /**
+     *  Match \c prefix without running its actions, and let the next token
+     *  decide how to go on: if \c test matches there, start over and parse
+     *  the same text with \c then_p; otherwise carry on after the prefix
+     *  with \c else_p. \c test is only looked at. Use shared_prefix() to
+     *  create one.
+     *
+     *  This is for two alternatives that start out the same: the common
+     *  part is read once, and only the branch that is taken runs actions.
+     */
+    template <typename PrefixT, typename TestT, typename ThenT, typename ElseT>
+    struct shared_prefix_parser
+      : public spirit::parser< shared_prefix_parser<PrefixT, TestT, ThenT, ElseT> >
+    {
+      typedef shared_prefix_parser<PrefixT, TestT, ThenT, ElseT> self_t;
+
+      typename PrefixT::embed_t         prefix;
+      typename TestT::embed_t           test;
+      typename ThenT::embed_t           then_p;
+      typename ElseT::embed_t           else_p;
+
+      shared_prefix_parser(PrefixT const & p, TestT const & t, ThenT const & a, ElseT const & b)
+        : prefix(p), test(t), then_p(a), else_p(b)
+      {
+      }
+
+      template <typename ScannerT>
+      typename spirit::parser_result<self_t, ScannerT>::type
+      parse(ScannerT const & scan) const
+      {
+        typedef typename ScannerT::iterator_t iterator_t;
+        iterator_t const save(scan.first);
+        std::ptrdiff_t const len( spirit::no_actions_d[prefix].parse(scan).length() );
+        if (len < 0)
+          return scan.no_match();
+        iterator_t const end(scan.first);
+        if (spirit::no_actions_d[test].parse(scan))
+        {
+          scan.first = save;
+          std::ptrdiff_t const n( then_p.parse(scan).length() );
+          if (n < 0)
+            return scan.no_match();
+          return scan.create_match(n, spirit::nil_t(), save, scan.first);
+        }
+        scan.first = end;
+        std::ptrdiff_t const n( else_p.parse(scan).length() );
+        if (n < 0)
+          return scan.no_match();
+        return scan.create_match(len + n, spirit::nil_t(), save, scan.first);
+      }
+    };
+
+    template <typename PrefixT, typename TestT, typename ThenT, typename ElseT>
+    inline shared_prefix_parser<PrefixT, TestT, ThenT, ElseT>
+    shared_prefix(PrefixT const & p, TestT const & t, ThenT const & a, ElseT const & b)
+    {
+      return shared_prefix_parser<PrefixT, TestT, ThenT, ElseT>(p, t, a, b);
+    }
+  }
+
+  template <typename StringT>
+  struct basic_local_part_parser
+    : public spirit::grammar< basic_local_part_parser<StringT>, typename basic_string_closure<StringT>::context_t >
+  {
+    basic_local_part_parser() { }
 
     template<typename scannerT>
     struct definition
     {
-      spirit::rule<scannerT>    local_part;
-      spirit::rule<scannerT>    word;
+      spirit::rule<scannerT, rule_context> local_part;
+      spirit::rule<scannerT, rule_context> word;
+      spirit::rule<scannerT, rule_context> dotted_word;
 
-      definition(local_part_parser const & self)
+      definition(basic_local_part_parser const & self)
       {
         using namespace spirit;
         using namespace phoenix;
 
+        // The dot is appended along with the word that follows it, so
+        // that a dot the star backtracks over doesn't end up in the result.
+
         local_part
-          = word >> *( ch_p('.') [self.val += '.'] >> word );
+          = word >> *( '.' >> dotted_word );
 
         word
-          = word_p [self.val += construct_<std::string>(arg1, arg2)];
+          = word_p [append_range(self.val, arg1, arg2)];
+
+        dotted_word
+          = word_p [(self.val += '.', append_range(self.val, arg1, arg2))];
 
-        BOOST_SPIRIT_DEBUG_NODE(local_part);
+        RFC2822_DEBUG_NODE(local_part);
       }
 
-      spirit::rule<scannerT> const & start() const { return local_part; }
+      spirit::rule<scannerT, rule_context> const & start() const { return local_part; }
     };
   };
 
-  struct domain_literal_parser : public spirit::grammar<domain_literal_parser, string_closure::context_t>
+  template <typename StringT>
+  struct basic_domain_literal_parser
+    : public spirit::grammar< basic_domain_literal_parser<StringT>, typename basic_string_closure<StringT>::context_t >
   {
-    domain_literal_parser() { }
+    basic_domain_literal_parser() { }
 
     template<typename scannerT>
     struct definition
     {
-      definition(domain_literal_parser const & self)
+      definition(basic_domain_literal_parser const & self)
       {
         using namespace spirit;
         using namespace phoenix;
@@ -73,7 +193,7 @@ namespace rfc2822
         dtext
           = lexeme_d
             [ +(  (anychar_p - (ch_p('[') | ']' | '\\' | cr_p))
-                        [ self.val += construct_<std::string>(arg1, arg2) ]
+                        [ append_range(self.val, arg1, arg2) ]
                |  lwsp_p
                         // ignored
                )
@@ -81,88 +201,108 @@ namespace rfc2822
           ;
 
         quoted_pair
-          = quoted_pair_p [ self.val += construct_<std::string>(arg1, arg2) ];
+          = quoted_pair_p [ append_range(self.val, arg1, arg2) ];
           ;
 
-        BOOST_SPIRIT_DEBUG_NODE(domain_literal);
-        BOOST_SPIRIT_DEBUG_NODE(dtext);
+        RFC2822_DEBUG_NODE(domain_literal);
+        RFC2822_DEBUG_NODE(dtext);
       }
 
-      spirit::rule<scannerT> const & start() const { return domain_literal; }
+      spirit::rule<scannerT, rule_context> const & start() const { return domain_literal; }
 
-      spirit::rule<scannerT> domain_literal;
-      spirit::rule<scannerT> dtext;
-      spirit::rule<scannerT> quoted_pair;
+      spirit::rule<scannerT, rule_context> domain_literal;
+      spirit::rule<scannerT, rule_context> dtext;
+      spirit::rule<scannerT, rule_context> quoted_pair;
     };
   };
 
-  struct domain_parser : public spirit::grammar<domain_parser, string_closure::context_t>
+  template <typename StringT>
+  struct basic_domain_parser
+    : public spirit::grammar< basic_domain_parser<StringT>, typename basic_string_closure<StringT>::context_t >
   {
-    domain_parser() { }
+    basic_domain_parser() { }
 
     template<typename scannerT>
     struct definition
     {
-      definition(domain_parser const & self)
+      basic_domain_literal_parser<StringT> const        domain_literal;
+      spirit::rule<scannerT, rule_context>              domain;
+      spirit::rule<scannerT, rule_context>              sub_domain;
+      spirit::rule<scannerT, rule_context>              dotted_sub_domain;
+
+      definition(basic_domain_parser const & self)
       {
         using namespace spirit;
         using namespace phoenix;
 
-        domain      = sub_domain >> *( ch_p('.') [self.val += '.'] >> sub_domain );
+        // As in local_part_p, a dot is appended along with what follows it.
 
-        sub_domain  =  atom_p           [self.val += construct_<std::string>(arg1, arg2)]
-                    |  domain_literal_p [self.val += arg1];
+        domain      = sub_domain >> *( '.' >> dotted_sub_domain );
 
-        BOOST_SPIRIT_DEBUG_NODE(domain);
-        BOOST_SPIRIT_DEBUG_NODE(sub_domain);
-      }
+        sub_domain  =  atom_p           [append_range(self.val, arg1, arg2)]
+                    |  domain_literal   [self.val += arg1];
 
-      spirit::rule<scannerT> const & start() const { return domain; }
+        dotted_sub_domain
+                    =  atom_p           [(self.val += '.', append_range(self.val, arg1, arg2))]
+                    |  domain_literal   [(self.val += '.', self.val += arg1)];
 
-      spirit::rule<scannerT> domain;
-      spirit::rule<scannerT> sub_domain;
+        RFC2822_DEBUG_NODE(domain);
+        RFC2822_DEBUG_NODE(sub_domain);
+        RFC2822_DEBUG_NODE(dotted_sub_domain);
+      }
+
+      spirit::rule<scannerT, rule_context> const & start() const { return domain; }
     };
   };
 
-  struct addr_spec_parser : public spirit::grammar<addr_spec_parser, string_closure::context_t>
+  template <typename StringT>
+  struct basic_addr_spec_parser
+    : public spirit::grammar< basic_addr_spec_parser<StringT>, typename basic_string_closure<StringT>::context_t >
   {
-    addr_spec_parser() { }
+    basic_addr_spec_parser() { }
 
     template<typename scannerT>
     struct definition
     {
-      spirit::rule<scannerT>    addr_spec;
+      basic_local_part_parser<StringT> const    local_part;
+      basic_domain_parser<StringT> const        domain;
+      spirit::rule<scannerT, rule_context>      addr_spec;
 
-      definition(addr_spec_parser const & self)
+      definition(basic_addr_spec_parser const & self)
       {
         using namespace spirit;
         using namespace phoenix;
 
         addr_spec
-          = local_part_p [self.val += arg1]
+          = simple_addr_spec_p [assign_range(self.val, arg1, arg2)]
+          | local_part   [self.val += arg1]
             >> ch_p('@') [self.val += '@']
-            >> domain_p  [self.val += arg1]
+            >> domain    [self.val += arg1]
           ;
 
-        BOOST_SPIRIT_DEBUG_NODE(addr_spec);
+        RFC2822_DEBUG_NODE(addr_spec);
       }
 
-      spirit::rule<scannerT> const & start() const { return addr_spec; }
+      spirit::rule<scannerT, rule_context> const & start() const { return addr_spec; }
     };
   };
 
-  struct route_addr_parser : public spirit::grammar<route_addr_parser, string_closure::context_t>
+  template <typename StringT>
+  struct basic_route_addr_parser
+    : public spirit::grammar< basic_route_addr_parser<StringT>, typename basic_string_closure<StringT>::context_t >
   {
-    route_addr_parser() { }
+    basic_route_addr_parser() { }
 
     template<typename scannerT>
     struct definition
     {
-      spirit::rule<scannerT> route_addr;
-      spirit::rule<scannerT> route;
-      spirit::rule<scannerT> hop;
+      basic_addr_spec_parser<StringT> const     addr_spec;
+      basic_domain_parser<StringT> const        domain;
+      spirit::rule<scannerT, rule_context>      route_addr;
+      spirit::rule<scannerT, rule_context>      route;
+      spirit::rule<scannerT, rule_context>      hop;
 
-      definition(route_addr_parser const & self)
+      definition(basic_route_addr_parser const & self)
       {
         using namespace spirit;
         using namespace phoenix;
@@ -170,7 +310,7 @@ namespace rfc2822
         route_addr
           = ch_p('<')           [self.val += '<' ]
             >> !route
-            >> addr_spec_p      [self.val += arg1]
+            >> addr_spec        [self.val += arg1]
             >> ch_p('>')        [self.val += '>' ]
           ;
 
@@ -184,47 +324,75 @@ namespace rfc2822
 
         hop
           = ch_p('@')           [self.val += '@' ]
-            >> domain_p         [self.val += arg1]
+            >> domain           [self.val += arg1]
           ;
 
-        BOOST_SPIRIT_DEBUG_NODE(route_addr);
-        BOOST_SPIRIT_DEBUG_NODE(route);
-        BOOST_SPIRIT_DEBUG_NODE(hop);
+        RFC2822_DEBUG_NODE(route_addr);
+        RFC2822_DEBUG_NODE(route);
+        RFC2822_DEBUG_NODE(hop);
       }
 
-      spirit::rule<scannerT> const & start() const { return route_addr; }
+      spirit::rule<scannerT, rule_context> const & start() const { return route_addr; }
     };
   };
 
-  struct mailbox_parser : public spirit::grammar<mailbox_parser, string_closure::context_t>
+  template <typename StringT>
+  struct basic_mailbox_parser
+    : public spirit::grammar< basic_mailbox_parser<StringT>, typename basic_string_closure<StringT>::context_t >
   {
-    mailbox_parser() { }
+    basic_mailbox_parser() { }
 
     template<typename scannerT>
     struct definition
     {
-      spirit::rule<scannerT> phrase;
-      spirit::rule<scannerT> mailbox;
+      basic_route_addr_parser<StringT> const    route_addr;
+      basic_local_part_parser<StringT> const    local_part;
+      basic_domain_parser<StringT> const        domain;
+      spirit::rule<scannerT, rule_context>      mailbox;
+      spirit::rule<scannerT, rule_context>      phrase_tail;
 
-      definition(mailbox_parser const & self)
+      definition(basic_mailbox_parser const & self)
       {
         using namespace spirit;
         using namespace phoenix;
 
-        phrase  = word_p >> *( word_p | '.' );
+        // A display name and a local part start out the same: with words
+        // separated by dots. Match that prefix once, then let the next
+        // token decide whether it was a local part or the beginning of a
+        // display name. The canonic local part is built only once an "@"
+        // has shown that it is one.
+
+        mailbox
+          = simple_addr_spec_p  [assign_range(self.val, arg1, arg2)]
+          | route_addr          [self.val = arg1]
+          | detail::shared_prefix
+            (  local_part
+            ,  ch_p('@')
+            ,  local_part       [self.val = arg1]
+               >> ch_p('@')     [self.val += '@']
+               >> domain        [self.val += arg1]
+            ,  phrase_tail
+               >> route_addr    [self.val = arg1]
+            )
+          ;
 
-        mailbox = (   !phrase >> route_addr_p   [self.val += arg1]
-                  |   addr_spec_p               [self.val += arg1]
-                  );
+        phrase_tail = *( word_p | '.' );
 
-        BOOST_SPIRIT_DEBUG_NODE(phrase);
-        BOOST_SPIRIT_DEBUG_NODE(mailbox);
+        RFC2822_DEBUG_NODE(mailbox);
+        RFC2822_DEBUG_NODE(phrase_tail);
       }
 
-      spirit::rule<scannerT> const & start() const { return mailbox; }
+      spirit::rule<scannerT, rule_context> const & start() const { return mailbox; }
     };
   };
 
+  typedef basic_local_part_parser<std::string>      local_part_parser;
+  typedef basic_domain_literal_parser<std::string>  domain_literal_parser;
+  typedef basic_domain_parser<std::string>          domain_parser;
+  typedef basic_addr_spec_parser<std::string>       addr_spec_parser;
+  typedef basic_route_addr_parser<std::string>      route_addr_parser;
+  typedef basic_mailbox_parser<std::string>         mailbox_parser;
+
 } // rfc2822
 
 #endif // RFC2822_ADDRESS_HPP_INCLUDED
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_ARENA_HPP_INCLUDED
+#define RFC2822_ARENA_HPP_INCLUDED
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <string>
+#include <boost/noncopyable.hpp>
+
+namespace rfc2822
+{
+  /**
+   *  A monotonic memory pool. Allocating moves a pointer through the
+   *  current block, deallocating does nothing, and all memory goes away at
+   *  once when the arena is released or destroyed. The first block may be
+   *  supplied by the caller, e.g. on the stack; further blocks come from
+   *  operator new.
+   *
+   *  Arenas are meant to be short-lived -- one per message, say -- and to
+   *  be used by one thread at a time.
+   */
+  class arena : private boost::noncopyable
+  {
+  public:
+    enum { alignment = 2 * sizeof(void *), default_block_size = 4096 };
+
+    explicit arena(std::size_t block_size = default_block_size);
+    arena(void * buffer, std::size_t size, std::size_t block_size = default_block_size);
+    ~arena() { release(); }
+
+    /// Return \p n bytes aligned for any type.
+    void * allocate(std::size_t n)
+    {
+      n = (n + alignment - 1u) & ~std::size_t(alignment - 1u);
+      if (static_cast<std::size_t>(end - next) < n)
+        grow(n);
+      void * const p( next );
+      next += n;
+      return p;
+    }
+
+    /// Free all blocks and start over at the beginning of the caller's buffer.
+    void release();
+
+    /**
+     *  Make an arena the one that default-constructed \c arena_allocator
+     *  objects use in this thread, for as long as the scope lasts. Scopes
+     *  nest.
+     */
+    class scope : private boost::noncopyable
+    {
+    public:
+      explicit scope(arena & a) : outer(current()) { make_current(&a); }
+      ~scope() { make_current(outer); }
+
+    private:
+      arena * const outer;
+    };
+
+    /// The arena of the innermost \c scope in this thread, or \c NULL.
+    static arena * current();
+
+  private:
+    struct block;
+
+    static void make_current(arena * a);
+    void grow(std::size_t n);
+
+    char * const        buffer_begin;
+    char * const        buffer_end;
+    char *              next;
+    char *              end;
+    block *             blocks;
+    std::size_t const   block_size;
+  };
+
+  /**
+   *  A standard allocator that takes its memory from an \c arena. A
+   *  default-constructed allocator uses arena::current(), or operator new
+   *  if there is none; that is how the closures of the string-building
+   *  parsers, which default-construct their values, find the arena. All
+   *  strings allocated from an arena must be gone before the arena is
+   *  released.
+   */
+  template <typename T>
+  class arena_allocator
+  {
+  public:
+    typedef T                   value_type;
+    typedef T *                 pointer;
+    typedef T const *           const_pointer;
+    typedef T &                 reference;
+    typedef T const &           const_reference;
+    typedef std::size_t         size_type;
+    typedef std::ptrdiff_t      difference_type;
+
+    template <typename U>
+    struct rebind
+    {
+      typedef arena_allocator<U> other;
+    };
+
+    arena_allocator() : pool(arena::current()) { }
+    explicit arena_allocator(arena & a) : pool(&a) { }
+    template <typename U>
+    arena_allocator(arena_allocator<U> const & other) : pool(other.pool) { }
+
+    pointer allocate(size_type n, void const * = 0)
+    {
+      if (pool)
+        return static_cast<pointer>(pool->allocate(n * sizeof(T)));
+      return static_cast<pointer>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(pointer p, size_type)
+    {
+      if (!pool)
+        ::operator delete(p);
+    }
+
+    void construct(pointer p, T const & val)    { new (static_cast<void *>(p)) T(val); }
+    void destroy(pointer p)                     { p->~T(); }
+    pointer address(reference r) const          { return &r; }
+    const_pointer address(const_reference r) const { return &r; }
+    size_type max_size() const                  { return std::numeric_limits<size_type>::max() / sizeof(T); }
+
+    template <typename U>
+    bool operator== (arena_allocator<U> const & other) const { return pool == other.pool; }
+    template <typename U>
+    bool operator!= (arena_allocator<U> const & other) const { return pool != other.pool; }
+
+  private:
+    template <typename U> friend class arena_allocator;
+
+    arena * pool;
+  };
+
+  /// A string for the address parsers that lives in the current arena.
+  typedef std::basic_string< char, std::char_traits<char>, arena_allocator<char> > arena_string;
+
+} // rfc2822
+
+#endif // RFC2822_ARENA_HPP_INCLUDED
@@ -13,7 +13,8 @@
 #ifndef RFC2822_ATOM_HPP_INCLUDED
 #define RFC2822_ATOM_HPP_INCLUDED
 
-#include "base.hpp"
+#include "char-class.hpp"
+#include "profile.hpp"
 
 namespace rfc2822
 {
@@ -24,24 +25,17 @@ namespace rfc2822
     template<typename scannerT>
     struct definition
     {
-      spirit::rule<scannerT>    atom;
+      spirit::rule<scannerT, rule_context> atom;
 
       definition(atom_parser const &)
       {
         using namespace spirit;
-        atom =
-          lexeme_d
-          [
-            +( anychar_p - ( chset_p(" \x7F()<>@,;:\\\".[]")
-                           | range_p('\x00','\x1F')
-                           )
-             )
-          ];
-
-        BOOST_SPIRIT_DEBUG_NODE(atom);
+        atom = lexeme_d[ atext_run_p ];
+
+        RFC2822_DEBUG_NODE(atom);
       }
 
-      spirit::rule<scannerT> const & start() const { return atom; }
+      spirit::rule<scannerT, rule_context> const & start() const { return atom; }
     };
   };
 
@@ -19,6 +19,24 @@
  *  the neat advantage of being self-contained. In case this trait matters to
  *  you, the legacy code is still available for download.
  *
+ *  \par Threads
+ *
+ *  By default, the parsers keep state in the global parser objects while
+ *  they run, so only one thread at a time may use them. Build the library
+ *  with BOOST_SPIRIT_THREADSAFE -- <code>configure --enable-threads</code>
+ *  and <code>b2 threading=multi</code> do that, and the generated
+ *  rfc2822/config.hpp passes it on to the library's users -- and all
+ *  parser objects, addr_spec_p, date_p, skipper_p, and the others
+ *  included, may be used by any number of threads at once.
+ *
+ *  In that case, every thread builds its own copy of a grammar's
+ *  definition the first time it uses that grammar, which takes a lock
+ *  that is shared with the other threads using it. From then on, a parse
+ *  takes no locks and writes to no memory that other threads use, so
+ *  throughput grows with the number of cores. Parsers that produce
+ *  strings allocate them with operator new, unless they are instantiated
+ *  for arena_string, whose arena is per thread, too.
+ *
  *  \see Boost Spirit Homepage: http://spirit.sf.net/
  *  \see IETF Request for Comment #2822: http://www.faqs.org/rfcs/rfc2822.html
  *  \see Librfc2822 snapshot: <a href="http://git.cryp.to/rfc2822?a=snapshot;h=HEAD">rfc2822-HEAD.tar.gz</a>
@@ -30,8 +48,23 @@
 #ifndef RFC2822_BASE_HPP_INCLUDED
 #define RFC2822_BASE_HPP_INCLUDED
 
+// Building with BOOST_SPIRIT_THREADSAFE makes the parsers safe to use from
+// several threads at once (see the main page), at a considerable cost in
+// speed: grammar definitions and closure frames are then looked up per
+// thread. Phoenix closures have a switch of their own, which Spirit doesn't
+// set. Either way, library and users must agree on the setting, so it is
+// recorded in rfc2822/config.hpp, which comes first. Include the headers
+// of this library before Spirit's own.
+
+#include <rfc2822/config.hpp>
+
+#if defined(BOOST_SPIRIT_THREADSAFE) && !defined(PHOENIX_THREADSAFE)
+#  define PHOENIX_THREADSAFE
+#endif
+
 #include <boost/spirit/include/classic.hpp>
 #include <boost/spirit/include/classic_chset.hpp>
+#include <string>
 
 /**
  *  \brief Internet Message Format Parsers
@@ -84,6 +117,30 @@ namespace rfc2822
   extern struct date_parser const date_p;
   /// \example date.cpp Parse e-mail <code>Date:</code> header.
 
+  /**
+   *  \brief Match the canonical <code>date-time</code> layout
+   *         <code>[Www, ]D[D] Mmm YYYY HH:MM:SS +ZZZZ</code> in a single
+   *         pass.
+   *
+   *  This is the fast path of date_p. It fails without consuming any input
+   *  on everything else.
+   *
+   *  \return A \c std::tm date stamp.
+   */
+  extern struct fixed_date_parser const fixed_date_p;
+
+  // The string-building address parsers are templates over the type of
+  // string they produce; the global objects below produce std::string.
+  // Instantiate them with arena_string to have all intermediate and final
+  // results allocated from an arena instead (see arena.hpp).
+
+  template <typename StringT> struct basic_local_part_parser;
+  template <typename StringT> struct basic_domain_literal_parser;
+  template <typename StringT> struct basic_domain_parser;
+  template <typename StringT> struct basic_addr_spec_parser;
+  template <typename StringT> struct basic_route_addr_parser;
+  template <typename StringT> struct basic_mailbox_parser;
+
   /**
    *  \brief Match <code>name-addr / addr-spec</code>.
    *
@@ -98,14 +155,139 @@ namespace rfc2822
    *
    *  \return A \c std::string containing the parsed, canonic address.
    */
-  extern struct mailbox_parser const mailbox_p;
+  extern basic_mailbox_parser<std::string> const mailbox_p;
   /// \example address.cpp Parse e-mail addresses.
 
   /**
    *  \brief Match <code>local_part_p "@" domain_p</code>.
    *  \return A \c std::string containing the parsed, canonic address.
    */
-  extern struct addr_spec_parser const addr_spec_p;
+  extern basic_addr_spec_parser<std::string> const addr_spec_p;
+
+  /**
+   *  \brief Match the common <code>dot-atom "@" dot-atom</code> form of an
+   *         addr-spec in a single pass.
+   *
+   *  This is the fast path of addr_spec_p. It fails without consuming any
+   *  input when the address contains comments, folding white space, quoted
+   *  strings, or domain literals; addr_spec_p then falls back to the full
+   *  grammar.
+   *
+   *  \return A pair of iterators designating the match, which is also the
+   *          canonic address.
+   */
+  extern struct simple_addr_spec_parser const simple_addr_spec_p;
+
+  template <typename IteratorT> struct addr_spec_view_parser;
+  template <typename IteratorT> struct mailbox_view_parser;
+
+  /**
+   *  \brief Match a <code>mailbox</code> like mailbox_p, but without
+   *         building any strings.
+   *
+   *  \return A \c mailbox_view designating the display name, local part,
+   *          domain, and route hops in the input.
+   */
+  extern mailbox_view_parser<char const *> const mailbox_view_p;
+
+  /**
+   *  \brief Match an <code>addr-spec</code> like addr_spec_p, but without
+   *         building any strings.
+   *
+   *  \return A \c mailbox_view designating local part and domain in the
+   *          input.
+   */
+  extern addr_spec_view_parser<char const *> const addr_spec_view_p;
+
+  /**
+   *  \brief Match an <code>addr-spec</code> like addr_spec_p, but copy the
+   *         result only if the input isn't canonic already.
+   *
+   *  \return A \c canonic_string with the same text addr_spec_p returns;
+   *          for a plain <code>dot-atom "@" dot-atom</code> address, it
+   *          designates the input rather than a copy. Works on
+   *          <code>char const *</code> ranges only.
+   */
+  extern struct addr_spec_ref_parser const addr_spec_ref_p;
+
+  /**
+   *  \brief Match a <code>mailbox</code> like mailbox_p, but copy the
+   *         result only if the input isn't canonic already.
+   *
+   *  \return A \c canonic_string with the same text mailbox_p returns; if
+   *          the address is a plain <code>dot-atom "@" dot-atom</code>,
+   *          possibly in angle brackets right next to it, it designates
+   *          the input rather than a copy. Works on <code>char const
+   *          *</code> ranges only.
+   */
+  extern struct mailbox_ref_parser const mailbox_ref_p;
+
+  struct interned_domain_parser_gen;
+  struct interned_addr_spec_parser_gen;
+
+  /**
+   *  \brief Match a <code>domain</code> like domain_p and look it up in a
+   *         \c domain_table.
+   *
+   *  <code>interned_domain_p(table)</code> enters the domain into \c table
+   *  if it isn't there yet. A plain dot-atom is case-folded and hashed as
+   *  it is scanned, without building a string. Works on <code>char const
+   *  *</code> ranges only.
+   *
+   *  \return The \c domain_id of the domain.
+   */
+  extern interned_domain_parser_gen const interned_domain_p;
+
+  /**
+   *  \brief Match an <code>addr-spec</code> like addr_spec_p, but return
+   *         the ID of the domain instead of the canonic address.
+   *
+   *  <code>interned_addr_spec_p(table)</code> works like
+   *  interned_domain_p for the domain part. Works on <code>char const
+   *  *</code> ranges only.
+   *
+   *  \return An \c interned_addr_spec with the raw local part and the
+   *          \c domain_id of the domain.
+   */
+  extern interned_addr_spec_parser_gen const interned_addr_spec_p;
+
+  struct mailbox_list_parser_gen;
+  struct address_list_parser_gen;
+
+  /**
+   *  \brief Match a <code>mailbox-list</code> and call a visitor for each
+   *         mailbox.
+   *
+   *  <pre>
+   *    mailbox-list  =  (mailbox *("," mailbox)) / obs-mbox-list
+   *    obs-mbox-list =  1*([mailbox] [CFWS] "," [CFWS]) [mailbox]
+   *  </pre>
+   *
+   *  <code>mailbox_list_p(v)</code> calls <code>v(m)</code> with a
+   *  \c mailbox_view for every mailbox in the list, in order, without
+   *  building any strings. Empty list elements are skipped, but the list
+   *  must contain at least one mailbox.
+   *
+   *  \return Nothing; the mailboxes are passed to the visitor.
+   */
+  extern mailbox_list_parser_gen const mailbox_list_p;
+
+  /**
+   *  \brief Match an <code>address-list</code> and call a visitor for each
+   *         mailbox.
+   *
+   *  <pre>
+   *    address-list  =  (address *("," address)) / obs-addr-list
+   *    address       =  mailbox / group
+   *    group         =  display-name ":" [mailbox-list / CFWS] ";" [CFWS]
+   *  </pre>
+   *
+   *  Like mailbox_list_p; the members of a group are visited with
+   *  mailbox_view::group set to the group's display name.
+   *
+   *  \return Nothing; the mailboxes are passed to the visitor.
+   */
+  extern address_list_parser_gen const address_list_p;
 
   /**
    *  \brief Match an obsolete <code>route</code> address.
@@ -118,13 +300,13 @@ namespace rfc2822
    *
    *  \return A \c std::string containing the parsed, canonic address.
    */
-  extern struct route_addr_parser const route_addr_p;
+  extern basic_route_addr_parser<std::string> const route_addr_p;
 
   /**
    *  \brief Match <code>dot-atom / quoted-string / obs-local-part</code>.
    *  \return A \c std::string containing the parsed local part.
    */
-  extern struct local_part_parser const local_part_p;
+  extern basic_local_part_parser<std::string> const local_part_p;
 
   /**
    *  \brief Match a <code>domain-literal</code>.
@@ -137,7 +319,7 @@ namespace rfc2822
    *
    *  \return A \c std::string containing the parsed domain literal.
    */
-  extern struct domain_literal_parser const domain_literal_p;
+  extern basic_domain_literal_parser<std::string> const domain_literal_p;
 
   /**
    *  \brief Match a <code>domain</code> name.
@@ -150,7 +332,7 @@ namespace rfc2822
    *
    *  \return A \c std::string containing the parsed domain literal.
    */
-  extern struct domain_parser const domain_p;
+  extern basic_domain_parser<std::string> const domain_p;
 
 
   /**
@@ -276,6 +458,24 @@ namespace rfc2822
    *  \return A pair of iterators designating the match.
    */
   extern struct quoted_pair_parser const quoted_pair_p;
+
+  /**
+   *  \brief Build the grammar definitions of all parsers now rather than
+   *         on first use.
+   *
+   *  Spirit builds a grammar's rules the first time the grammar is used
+   *  with a given scanner, so the first parse of each kind is much slower
+   *  than the ones after it. This function runs every parser over sample
+   *  input, as <code>char const *</code> ranges with and without
+   *  skipper_p, with and without <code>no_actions_d</code>, and through
+   *  bounded_parse(), so that later parses like these find everything in
+   *  place.
+   *  Call it at startup; the global parser objects are constructed during
+   *  static initialization in an unspecified order, so it can't be called
+   *  from there. In a thread-safe build, every thread has its own
+   *  definitions, so call it at the start of each thread.
+   */
+  void prepare_parsers();
 }
 
 #define PP_PHOENIX_DEFINE_RECORD_ACCESSOR(NAME, TYPE, ACC)      \
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_BUDGET_HPP_INCLUDED
+#define RFC2822_BUDGET_HPP_INCLUDED
+
+#include "base.hpp"
+#include <cstddef>
+#include <iterator>
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/is_base_of.hpp>
+
+namespace rfc2822
+{
+  /**
+   *  Limits on the work a single parse may do. A step is one character
+   *  examined; characters that are examined again after backtracking cost
+   *  again. Once a limit is hit, the scanner reports the end of input, so
+   *  that every parser in progress fails right away, and \c exceeded is
+   *  set.
+   */
+  struct parse_budget
+  {
+    std::size_t max_steps;
+    std::size_t max_comment_depth;
+    std::size_t steps;                  ///< Steps taken so far.
+    bool        exceeded;
+
+    explicit parse_budget( std::size_t max_steps_         = std::size_t(-1)
+                         , std::size_t max_comment_depth_ = std::size_t(-1)
+                         )
+      : max_steps(max_steps_), max_comment_depth(max_comment_depth_), steps(0u), exceeded(false)
+    {
+    }
+
+    /// Spend \p n steps; \c false if that exceeds the budget.
+    bool charge(std::size_t n)
+    {
+      steps += n;
+      if (steps > max_steps)
+        exceeded = true;
+      return !exceeded;
+    }
+  };
+
+  /// Scanner iteration policy that charges every character to a budget.
+  struct budget_iteration_policy : public spirit::iteration_policy
+  {
+    explicit budget_iteration_policy(parse_budget & b) : budget(&b) { }
+
+    template <typename ScannerT>
+    void advance(ScannerT const & scan) const
+    {
+      ++scan.first;
+      budget->charge(1u);
+    }
+
+    template <typename ScannerT>
+    bool at_end(ScannerT const & scan) const
+    {
+      return budget->exceeded || scan.first == scan.last;
+    }
+
+    parse_budget * budget;
+  };
+
+  inline parse_budget * budget_of(budget_iteration_policy const & policy, boost::true_type)
+  {
+    return policy.budget;
+  }
+
+  template <typename ScannerT>
+  inline parse_budget * budget_of(ScannerT const &, boost::false_type)
+  {
+    return 0;
+  }
+
+  /// The budget a scanner charges to, or \c NULL for ordinary scanners.
+  template <typename ScannerT>
+  inline parse_budget * budget_of(ScannerT const & scan)
+  {
+    return budget_of(scan, boost::is_base_of<budget_iteration_policy, ScannerT>());
+  }
+
+  /**
+   *  Charge \p n steps to the scanner's budget, if it has one. Parsers
+   *  that move through the input on their own rather than with the
+   *  scanner's help call this, and fail if it returns \c false.
+   */
+  template <typename ScannerT>
+  inline bool charge(ScannerT const & scan, std::size_t n)
+  {
+    parse_budget * const b( budget_of(scan) );
+    return !b || b->charge(n);
+  }
+
+  namespace detail
+  {
+    /// How far past the end of a match a parser may look to decide on it.
+    std::size_t const budget_lookahead = 3u;
+
+    template <typename IteratorT>
+    inline IteratorT budget_end(IteratorT const & first, IteratorT const & last, parse_budget const * b, std::random_access_iterator_tag)
+    {
+      if (!b)
+        return last;
+      std::size_t const left( b->steps < b->max_steps ? b->max_steps - b->steps : 0u );
+      std::size_t const n( static_cast<std::size_t>(last - first) );
+      if (n <= left || n - left <= budget_lookahead + 1u)
+        return last;
+      return first + static_cast<std::ptrdiff_t>(left + budget_lookahead + 1u);
+    }
+
+    template <typename IteratorT>
+    inline IteratorT budget_end(IteratorT const &, IteratorT const & last, parse_budget const *, std::input_iterator_tag)
+    {
+      return last;
+    }
+  }
+
+  /**
+   *  Where a parser that moves through the input on its own should stop
+   *  looking: a few characters past what the scanner's budget can still
+   *  pay for, or the end of input. A match that reaches that far costs
+   *  more than is left, and a parser that looks at most
+   *  detail::budget_lookahead characters past its match decides just as
+   *  it would on the whole input. Without a budget, or with iterators
+   *  that aren't random access, this is the end of input.
+   */
+  template <typename ScannerT>
+  inline typename ScannerT::iterator_t budget_end(ScannerT const & scan)
+  {
+    typedef typename ScannerT::iterator_t iterator_t;
+    return detail::budget_end( scan.first, scan.last, budget_of(scan)
+                             , typename std::iterator_traits<iterator_t>::iterator_category()
+                             );
+  }
+
+  /// Like spirit::parse_info, but tells whether the budget ran out.
+  template <typename IteratorT = char const *>
+  struct bounded_parse_info : public spirit::parse_info<IteratorT>
+  {
+    bool        exceeded;       ///< The parse failed because it ran out of budget.
+
+    bounded_parse_info(spirit::parse_info<IteratorT> const & info, bool exceeded_)
+      : spirit::parse_info<IteratorT>(info), exceeded(exceeded_)
+    {
+      if (exceeded)
+        this->hit = this->full = false;
+    }
+  };
+
+  /**
+   *  \brief Run a parser like spirit::parse() does, but within a budget.
+   *
+   *  The parsers are instantiated for a scanner of their own; call
+   *  prepare_parsers() to have their definitions built up front.
+   */
+  template <typename IteratorT, typename ParserT, typename SkipT>
+  inline bounded_parse_info<IteratorT>
+  bounded_parse( IteratorT const & first_, IteratorT const & last
+               , spirit::parser<ParserT> const & p, spirit::parser<SkipT> const & skip
+               , parse_budget & budget
+               )
+  {
+    typedef spirit::skip_parser_iteration_policy<SkipT, budget_iteration_policy> iteration_policy_t;
+    typedef spirit::scanner_policies<iteration_policy_t>                         scanner_policies_t;
+    typedef spirit::scanner<IteratorT, scanner_policies_t>                       scanner_t;
+
+    iteration_policy_t iteration_policy(skip.derived(), budget_iteration_policy(budget));
+    scanner_policies_t policies(iteration_policy);
+    IteratorT first = first_;
+    scanner_t scan(first, last, policies);
+    spirit::match<spirit::nil_t> const hit = p.derived().parse(scan);
+    return bounded_parse_info<IteratorT>( spirit::parse_info<IteratorT>(first, hit, hit && first == last, hit.length())
+                                        , budget.exceeded
+                                        );
+  }
+
+  /// Like bounded_parse() above, but without a skipper.
+  template <typename IteratorT, typename ParserT>
+  inline bounded_parse_info<IteratorT>
+  bounded_parse( IteratorT const & first_, IteratorT const & last
+               , spirit::parser<ParserT> const & p
+               , parse_budget & budget
+               )
+  {
+    typedef spirit::scanner_policies<budget_iteration_policy>   scanner_policies_t;
+    typedef spirit::scanner<IteratorT, scanner_policies_t>      scanner_t;
+
+    scanner_policies_t policies((budget_iteration_policy(budget)));
+    IteratorT first = first_;
+    scanner_t scan(first, last, policies);
+    spirit::match<spirit::nil_t> const hit = p.derived().parse(scan);
+    return bounded_parse_info<IteratorT>( spirit::parse_info<IteratorT>(first, hit, hit && first == last, hit.length())
+                                        , budget.exceeded
+                                        );
+  }
+
+} // rfc2822
+
+#endif // RFC2822_BUDGET_HPP_INCLUDED
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_CANONIC_STRING_HPP_INCLUDED
+#define RFC2822_CANONIC_STRING_HPP_INCLUDED
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+namespace rfc2822
+{
+  /**
+   *  The canonic form of a parsed text. When the input was canonic to begin
+   *  with -- no comments, folding, or white space to remove -- the object
+   *  merely designates the matched part of the input, which must then
+   *  outlive it. Otherwise, it holds a canonic copy of its own.
+   */
+  class canonic_string
+  {
+  public:
+    typedef char const *        const_iterator;
+
+    canonic_string() : first(0), last(0), copied(false) { }
+
+    /// Designate <code>[b, e)</code> of the input.
+    void assign(char const * b, char const * e)
+    {
+      first  = b;
+      last   = e;
+      copied = false;
+    }
+
+    /// Store a canonic copy.
+    void assign(std::string const & s)
+    {
+      copy   = s;
+      copied = true;
+    }
+
+    /// \c true if the text lies within the parsed input.
+    bool is_slice() const               { return !copied; }
+
+    const_iterator begin() const        { return copied ? copy.data() : first; }
+    const_iterator end() const          { return copied ? copy.data() + copy.size() : last; }
+    std::size_t size() const            { return static_cast<std::size_t>(end() - begin()); }
+    bool empty() const                  { return begin() == end(); }
+    std::string str() const             { return std::string(begin(), end()); }
+
+  private:
+    char const *        first;
+    char const *        last;
+    std::string         copy;
+    bool                copied;
+  };
+
+  inline bool operator== (canonic_string const & lhs, std::string const & rhs)
+  {
+    return lhs.size() == rhs.size() && rhs.compare(0u, rhs.size(), lhs.begin(), lhs.size()) == 0;
+  }
+
+  inline bool operator!= (canonic_string const & lhs, std::string const & rhs)
+  {
+    return !(lhs == rhs);
+  }
+
+  inline std::ostream & operator<< (std::ostream & os, canonic_string const & s)
+  {
+    return os.write(s.begin(), static_cast<std::streamsize>(s.size()));
+  }
+
+} // rfc2822
+
+#endif // RFC2822_CANONIC_STRING_HPP_INCLUDED
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_CHAR_CLASS_HPP_INCLUDED
+#define RFC2822_CHAR_CLASS_HPP_INCLUDED
+
+#include "base.hpp"
+#include "budget.hpp"
+#include <cstddef>
+#include <iterator>
+
+namespace rfc2822
+{
+  /**
+   *  Character classes as the grammars use them. Note that qtext and ctext
+   *  are wider than in the standard: white space is part of both, because
+   *  quoted_string_p and comment_p keep it verbatim.
+   *
+   *  <pre>
+   *    atext  =  anything but specials, SP, DEL, and CTLs
+   *    qtext  =  anything but DQUOTE, "\", and CR
+   *    ctext  =  anything but "(", ")", "\", and CR
+   *    WSP    =  SP / HT
+   *  </pre>
+   */
+  enum char_class
+    { atext_class = 1
+    , qtext_class = 2
+    , ctext_class = 4
+    , wsp_class   = 8
+    };
+
+  /// Classification of all byte values as a combination of char_class bits.
+  extern unsigned char const char_class_table[256];
+
+  /// Instruction sets for which span kernels exist.
+  enum simd_level { simd_none, simd_sse2, simd_avx2 };
+
+  /**
+   *  A set of kernels that return the length of the longest prefix of
+   *  <code>[first, last)</code> consisting only of characters of the
+   *  respective class.
+   */
+  struct span_kernels
+  {
+    std::size_t (*atext)(char const * first, char const * last);
+    std::size_t (*qtext)(char const * first, char const * last);
+    std::size_t (*ctext)(char const * first, char const * last);
+    std::size_t (*wsp)(char const * first, char const * last);
+  };
+
+  /// The kernels for a given instruction set, or NULL if neither this build
+  /// nor the CPU we're running on support it.
+  span_kernels const * get_span_kernels(simd_level level);
+
+  /// The fastest kernels the CPU supports. Determined on first use.
+  span_kernels const & best_span_kernels();
+
+  inline std::size_t atext_span(char const * first, char const * last)
+  {
+    return best_span_kernels().atext(first, last);
+  }
+
+  inline std::size_t qtext_span(char const * first, char const * last)
+  {
+    return best_span_kernels().qtext(first, last);
+  }
+
+  inline std::size_t ctext_span(char const * first, char const * last)
+  {
+    return best_span_kernels().ctext(first, last);
+  }
+
+  inline std::size_t wsp_span(char const * first, char const * last)
+  {
+    return best_span_kernels().wsp(first, last);
+  }
+
+  template <int ClassT> struct span_kernel;
+
+  template <> struct span_kernel<atext_class>
+  {
+    static std::size_t run(char const * first, char const * last) { return atext_span(first, last); }
+  };
+
+  template <> struct span_kernel<qtext_class>
+  {
+    static std::size_t run(char const * first, char const * last) { return qtext_span(first, last); }
+  };
+
+  template <> struct span_kernel<ctext_class>
+  {
+    static std::size_t run(char const * first, char const * last) { return ctext_span(first, last); }
+  };
+
+  template <> struct span_kernel<wsp_class>
+  {
+    static std::size_t run(char const * first, char const * last) { return wsp_span(first, last); }
+  };
+
+  /**
+   *  Match one or more characters of the given class. Contiguous character
+   *  buffers are scanned with the vectorized kernels; any other kind of
+   *  iterator falls back to a table lookup per character.
+   */
+  template <int ClassT>
+  struct span_parser : public spirit::parser< span_parser<ClassT> >
+  {
+    typedef span_parser<ClassT> self_t;
+
+    span_parser() { }
+
+    template <typename IteratorT>
+    static IteratorT span_end(IteratorT first, IteratorT last)
+    {
+      while (first != last && (char_class_table[static_cast<unsigned char>(*first)] & ClassT))
+        ++first;
+      return first;
+    }
+
+    static char const * span_end(char const * first, char const * last)
+    {
+      return first + span_kernel<ClassT>::run(first, last);
+    }
+
+    static char * span_end(char * first, char * last)
+    {
+      return first + span_kernel<ClassT>::run(first, last);
+    }
+
+    template <typename ScannerT>
+    typename spirit::parser_result<self_t, ScannerT>::type
+    parse(ScannerT const & scan) const
+    {
+      typedef typename ScannerT::iterator_t iterator_t;
+
+      if (scan.at_end())
+        return scan.no_match();
+      iterator_t const save(scan.first);
+      iterator_t const stop(span_end(scan.first, budget_end(scan)));
+      std::size_t const len( std::distance(save, stop) );
+      if (!len || !charge(scan, len))
+        return scan.no_match();
+      scan.first = stop;
+      return scan.create_match(len, spirit::nil_t(), save, stop);
+    }
+  };
+
+  span_parser<atext_class> const atext_run_p = span_parser<atext_class>(); ///< \brief Match <code>1*atext</code>.
+  span_parser<qtext_class> const qtext_run_p = span_parser<qtext_class>(); ///< \brief Match <code>1*qtext</code>.
+  span_parser<ctext_class> const ctext_run_p = span_parser<ctext_class>(); ///< \brief Match <code>1*ctext</code>.
+  span_parser<wsp_class>   const wsp_run_p   = span_parser<wsp_class>();   ///< \brief Match <code>1*WSP</code>.
+
+} // rfc2822
+
+#endif // RFC2822_CHAR_CLASS_HPP_INCLUDED
@@ -13,11 +13,92 @@
 #ifndef RFC2822_COMMENT_HPP_INCLUDED
 #define RFC2822_COMMENT_HPP_INCLUDED
 
-#include "lwsp.hpp"
-#include "quoted-pair.hpp"
+#include "profile.hpp"
+#include "budget.hpp"
+#include "char-class.hpp"
 
 namespace rfc2822
 {
+  /**
+   *  Match <code>"(" *(lwsp_p | 1*ctext | quoted_pair_p | comment) ")"</code>
+   *  in a single loop that counts the nesting depth, so that deeply nested
+   *  comments cost no stack. A <code>CR</code> must start a fold, i.e. be
+   *  followed by <code>LF</code> and white space. Under a parse_budget, the
+   *  characters are charged to the budget and nesting deeper than
+   *  parse_budget::max_comment_depth exceeds it.
+   */
+  struct nested_comment_parser : public spirit::parser<nested_comment_parser>
+  {
+    typedef nested_comment_parser self_t;
+
+    nested_comment_parser() { }
+
+    template <typename ScannerT, typename IteratorT>
+    static typename spirit::parser_result<self_t, ScannerT>::type
+    fail(ScannerT const & scan, IteratorT const & save, IteratorT const & it)
+    {
+      charge(scan, std::distance(save, it));
+      return scan.no_match();
+    }
+
+    template <typename ScannerT>
+    typename spirit::parser_result<self_t, ScannerT>::type
+    parse(ScannerT const & scan) const
+    {
+      typedef typename ScannerT::iterator_t iterator_t;
+
+      if (scan.at_end() || *scan.first != '(')
+        return scan.no_match();
+
+      parse_budget * const budget( budget_of(scan) );
+      std::size_t const max_depth( budget ? budget->max_comment_depth : std::size_t(-1) );
+      iterator_t const save(scan.first);
+      iterator_t const last(budget_end(scan));
+      iterator_t it(save);
+      std::size_t depth( 0u );
+      for (;;)
+      {
+        if (it == last)
+          return fail(scan, save, it);
+        switch (*it)
+        {
+          case '(':
+            if (++depth > max_depth)
+            {
+              budget->exceeded = true;
+              return fail(scan, save, it);
+            }
+            ++it;
+            break;
+          case ')':
+            ++it;
+            if (--depth == 0u)
+            {
+              std::size_t const len( std::distance(save, it) );
+              if (!charge(scan, len))
+                return scan.no_match();
+              scan.first = it;
+              return scan.create_match(len, spirit::nil_t(), save, it);
+            }
+            break;
+          case '\\':
+            if (++it == last)
+              return fail(scan, save, it);
+            ++it;
+            break;
+          case '\r':
+            if (++it == last || *it != '\n')
+              return fail(scan, save, it);
+            if (++it == last || (*it != ' ' && *it != '\t'))
+              return fail(scan, save, it);
+            break;
+          default:
+            it = span_parser<ctext_class>::span_end(it, last);
+        }
+      }
+    }
+  };
+
   struct comment_parser : public spirit::grammar<comment_parser>
   {
     comment_parser() { }
@@ -25,22 +106,16 @@ namespace rfc2822
     template<typename scannerT>
     struct definition
     {
-      spirit::rule<scannerT>    top;
-      spirit::subrule<0>        comment;
-      spirit::subrule<1>        ctext;
+      spirit::rule<scannerT, rule_context> top;
 
       definition(comment_parser const &)
       {
-        using namespace spirit;
-        top
-          = lexeme_d
-            [ comment = ch_p('(') >> *( lwsp_p | ctext | quoted_pair_p | comment ) >> ')'
-            , ctext   = anychar_p - (chset_p("()\\") | cr_p)
-            ]
-          ;
+        top = nested_comment_parser();
+
+        RFC2822_DEBUG_NODE(top);
       }
 
-      spirit::rule<scannerT> const & start() const { return top; }
+      spirit::rule<scannerT, rule_context> const & start() const { return top; }
     };
   };
 
@@ -13,7 +13,7 @@
 #ifndef RFC2822_CRLF_HPP_INCLUDED
 #define RFC2822_CRLF_HPP_INCLUDED
 
-#include "base.hpp"
+#include "profile.hpp"
 
 namespace rfc2822
 {
@@ -24,17 +24,17 @@ namespace rfc2822
     template<typename scannerT>
     struct definition
     {
-      spirit::rule<scannerT>    crlf;
+      spirit::rule<scannerT, rule_context> crlf;
 
       definition(crlf_parser const &)
       {
         using namespace spirit;
         crlf = lexeme_d[ cr_p >> lf_p ];
 
-        BOOST_SPIRIT_DEBUG_NODE(crlf);
+        RFC2822_DEBUG_NODE(crlf);
       }
 
-      spirit::rule<scannerT> const & start() const { return crlf; }
+      spirit::rule<scannerT, rule_context> const & start() const { return crlf; }
     };
   };
 
@@ -13,26 +13,16 @@
 #ifndef RFC2822_DATE_HPP_INCLUDED
 #define RFC2822_DATE_HPP_INCLUDED
 
-#include "base.hpp"
+#include "budget.hpp"
+#include "keyword.hpp"
+#include "profile.hpp"
+#include "timestamp.hpp"
 #include <boost/spirit/include/classic_closure.hpp>
-#include <boost/spirit/include/classic_symbols.hpp>
 #include <boost/spirit/include/phoenix1_binders.hpp>
-#include <boost/compatibility/cpp_c_headers/ctime>
-#include <boost/compatibility/cpp_c_headers/cstring>
+#include <iterator>
 
 namespace rfc2822
 {
-  struct timestamp : public std::tm
-  {
-    timestamp()    { std::memset(this, 0, sizeof(*this)); }
-    int tzoffset;
-  };
-
-  inline std::ostream & operator<< (std::ostream & os, timestamp const & ts)
-  {
-    return os << std::asctime(&ts);
-  }
-
   PP_PHOENIX_DEFINE_TRIVIAL_RECORD_ACCESSOR(tm_sec,   int &);
   PP_PHOENIX_DEFINE_TRIVIAL_RECORD_ACCESSOR(tm_min,   int &);
   PP_PHOENIX_DEFINE_TRIVIAL_RECORD_ACCESSOR(tm_hour,  int &);
@@ -49,46 +39,111 @@ namespace rfc2822
     member1 val;
   };
 
-  struct month_parser : public spirit::symbols<int>
+  struct month_table : public keyword_table<0x055455E9u, 4>
   {
-    month_parser()
+    template <unsigned Slot> struct slot
     {
-      add ("jan", 0)("feb", 1)("mar", 2)("apr", 3)
-          ("may", 4)("jun", 5)("jul", 6)("aug", 7)
-          ("sep", 8)("oct", 9)("nov", 10)("dec", 11);
-    }
+      static boost::uint32_t const key = 0u;
+      static int const value = 0;
+    };
+    static keyword_entry const entries[size];
+  };
+
+  struct month_parser : public keyword_parser<month_table>
+  {
+    month_parser() { }
   };
 
-  struct wday_parser : public spirit::symbols<int>
+  struct wday_table : public keyword_table<0x91B7584Bu, 4>
   {
-    wday_parser()
+    template <unsigned Slot> struct slot
     {
-      add ("sun", 0)("mon", 1)("tue", 2)("wed", 3)
-          ("thu", 4)("fri", 5)("sat", 6);
-    }
+      static boost::uint32_t const key = 0u;
+      static int const value = 0;
+    };
+    static keyword_entry const entries[size];
   };
 
-  struct timezone_parser : public spirit::symbols<int>
+  struct wday_parser : public keyword_parser<wday_table>
   {
-    timezone_parser()
+    wday_parser() { }
+  };
+
+  struct timezone_table : public keyword_table<0xE1988AD9u, 6>
+  {
+    template <unsigned Slot> struct slot
     {
-      add ("ut", 0)("gmt", 0)
-          ("est", -18000)("edt", -14400)
-          ("cst", -21600)("cdt", -18000)
-          ("mst", -25200)("mdt", -21600)
-          ("pst", -28800)("pdt", -25200)
-          ("z", 0)("a", -3600)("m", -43200)("n", +3600)("y", +43200);
+      static boost::uint32_t const key = 0u;
+      static int const value = 0;
+    };
+    static keyword_entry const entries[size];
+  };
+
+  struct timezone_parser : public keyword_parser<timezone_table>
+  {
+    timezone_parser() { }
+  };
+
+  /**
+   *  Recognize the canonical layout <code>[Www, ]D[D] Mmm YYYY HH:MM:SS
+   *  +ZZZZ</code> with single blanks and decode it with word-sized
+   *  arithmetic. Anything else -- including years before 1900 -- makes the
+   *  parser fail without consuming input so that the caller can fall back
+   *  to the full grammar. Only contiguous character buffers are scanned;
+   *  the parser never matches on other iterator types.
+   */
+  struct fixed_date_parser : public spirit::parser<fixed_date_parser>
+  {
+    typedef fixed_date_parser self_t;
+
+    template <typename ScannerT>
+    struct result
+    {
+      typedef typename spirit::match_result<ScannerT, timestamp>::type type;
+    };
+
+    fixed_date_parser() { }
+
+    /// Return the length of the match, or 0.
+    static std::size_t scan(timestamp & ts, char const * first, char const * last);
+
+    template <typename IteratorT>
+    static std::size_t scan(timestamp &, IteratorT, IteratorT)
+    {
+      return 0u;
+    }
+
+    template <typename ScannerT>
+    typename spirit::parser_result<self_t, ScannerT>::type
+    parse(ScannerT const & scan) const
+    {
+      typedef typename ScannerT::iterator_t iterator_t;
+
+      if (scan.at_end())        // also gives the skipper a chance to run
+        return scan.no_match();
+      timestamp ts;
+      std::size_t const len( self_t::scan(ts, scan.first, scan.last) );
+      if (!len || !charge(scan, len))
+        return scan.no_match();
+      iterator_t const save(scan.first);
+      std::advance(scan.first, len);
+      return scan.create_match(len, ts, save, scan.first);
     }
   };
 
   struct date_parser : public spirit::grammar<date_parser, timestamp_closure::context_t>
   {
-    date_parser() { }
+    /// The fast path can be disabled to get the plain grammar, e.g. to
+    /// test one against the other.
+    explicit date_parser(bool fast_path_ = true) : fast_path(fast_path_) { }
+
+    bool const fast_path;
 
     template<typename scannerT>
     struct definition
     {
-      spirit::rule<scannerT>                    top;
+      spirit::rule<scannerT, rule_context>      top;
+      spirit::rule<scannerT, rule_context>      full;
       spirit::subrule<0>                        date_time;
       spirit::subrule<1>                        date;
       spirit::subrule<2>                        time;
@@ -100,7 +155,12 @@ namespace rfc2822
         using namespace spirit;
         using namespace phoenix;
 
-        top =
+        if (self.fast_path)
+          top = fixed_date_p [self.val = arg1] | full;
+        else
+          top = full;
+
+        full =
           (
             date_time = !(    lexeme_d
                               [
@@ -157,9 +217,12 @@ namespace rfc2822
                             ]
                         ]
           );
+
+        RFC2822_DEBUG_NODE(top);
+        RFC2822_DEBUG_NODE(full);
       }
 
-      spirit::rule<scannerT> const & start() const { return top; }
+      spirit::rule<scannerT, rule_context> const & start() const { return top; }
     };
   };
 
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_DOMAIN_TABLE_HPP_INCLUDED
+#define RFC2822_DOMAIN_TABLE_HPP_INCLUDED
+
+#include <cstddef>
+#include <string>
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_array.hpp>
+
+namespace rfc2822
+{
+  /// The number of a domain in a \c domain_table; 0 is no domain.
+  typedef boost::uint32_t domain_id;
+
+  /**
+   *  A table that assigns every domain name a number, its \c domain_id.
+   *  Names are compared without regard to the case of ASCII letters and
+   *  stored in lower case; the IDs are handed out in order, starting at 1,
+   *  and stay valid for the lifetime of the table. interned_domain_p and
+   *  interned_addr_spec_p produce IDs straight from the input.
+   *
+   *  Lookups never lock and never write to shared memory. The table is
+   *  split into shards by hash, each of which has a lock of its own that
+   *  only inserts into that shard take; with BOOST_SPIRIT_THREADSAFE, any
+   *  number of threads may use a table at once. Entries are never removed.
+   */
+  class domain_table : private boost::noncopyable
+  {
+  public:
+    enum { shard_bits = 6, shards = 1 << shard_bits };
+
+    static domain_id const no_domain = 0u;
+
+    domain_table();
+    ~domain_table();
+
+    /// \name Case-folding hash
+    /// The hash of a name is <code>hash_step(...hash_step(hash_seed,
+    /// c1)..., cn)</code>; parsers compute it as they scan the name.
+    //@{
+    static boost::uint64_t const hash_seed = 14695981039346656037ull;
+
+    static char fold(char c)
+    {
+      return c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c;
+    }
+
+    static boost::uint64_t hash_step(boost::uint64_t h, char c)
+    {
+      return (h ^ static_cast<unsigned char>(fold(c))) * 1099511628211ull;
+    }
+
+    static boost::uint64_t hash(char const * first, char const * last);
+    //@}
+
+    /// The ID of <code>[first, last)</code>, or \c no_domain if it isn't in the table.
+    domain_id find(char const * first, char const * last) const
+    {
+      return find(first, last, hash(first, last));
+    }
+
+    domain_id find(char const * first, char const * last, boost::uint64_t h) const;
+
+    /// The ID of <code>[first, last)</code>, which is added if need be.
+    domain_id intern(char const * first, char const * last)
+    {
+      return intern(first, last, hash(first, last));
+    }
+
+    domain_id intern(char const * first, char const * last, boost::uint64_t h)
+    {
+      domain_id const id( find(first, last, h) );
+      return id ? id : insert(first, last, h);
+    }
+
+    /// The name of an ID the table has handed out, in lower case.
+    std::string const & name(domain_id id) const;
+
+    /**
+     *  The number of names in the table. All IDs up to this one have
+     *  been handed out and may be passed to name(); while other threads
+     *  insert, an ID can be in use a little before it's counted here.
+     */
+    std::size_t size() const { return published.load(boost::memory_order_acquire); }
+
+  private:
+    struct entry;
+    struct slots;
+    struct shard;
+
+    enum { chunk_bits = 10, chunk_size = 1 << chunk_bits, max_chunks = 1 << 14 };
+
+    typedef boost::atomic<entry const *> entry_slot;
+
+    domain_id insert(char const * first, char const * last, boost::uint64_t h);
+    void publish(entry const * e);
+
+    boost::scoped_array<shard>                          shard_table;
+    boost::atomic<std::size_t>                          count;          ///< IDs handed out.
+    boost::atomic<std::size_t>                          published;      ///< IDs filed, with no gaps.
+    boost::scoped_array< boost::atomic<entry_slot *> >  chunks;
+  };
+
+} // rfc2822
+
+#endif // RFC2822_DOMAIN_TABLE_HPP_INCLUDED
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_HEADER_HPP_INCLUDED
+#define RFC2822_HEADER_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+#include <boost/range/iterator_range.hpp>
+
+namespace rfc2822
+{
+  /**
+   *  A header field as a pair of ranges into the message. The value is the
+   *  raw text between the colon and the CRLF that ends the field, folds
+   *  included, so it can be handed to date_p, mailbox_p, and friends as it
+   *  is: a fold is a CRLF followed by WSP, which is exactly what lwsp_p and
+   *  skipper_p skip.
+   */
+  struct header_field
+  {
+    typedef boost::iterator_range<char const *> range_type;
+
+    range_type  name;           ///< The field name, without the colon and any white space in front of it.
+    range_type  value;          ///< The raw field body.
+
+    header_field() { }
+    header_field(range_type const & n, range_type const & v) : name(n), value(v) { }
+  };
+
+  enum header_status
+    { header_complete           ///< The header ended with an empty line or at the end of input.
+    , header_partial            ///< More input is needed to finish the field at stop.
+    , header_malformed          ///< The line at stop is not a header field.
+    };
+
+  struct header_info
+  {
+    char const *        stop;   ///< The start of the body if complete; the first field not yet split otherwise.
+    header_status       status;
+
+    header_info(char const * s, header_status st) : stop(s), status(st) { }
+  };
+
+  /**
+   *  \brief Split a message header into fields.
+   *
+   *  Lines end with a CRLF, just like crlf_p expects; a CR or LF on its own
+   *  is part of the field. Field names may be followed by white space before
+   *  the colon, as the obsolete syntax allows. Every field found is appended
+   *  to \p fields. No bytes are copied, and the only allocation is the
+   *  growth of \p fields.
+   *
+   *  A field is finished only once the first character of the next line
+   *  shows that it doesn't continue there. So unless \p at_eof is true, a
+   *  header that isn't terminated by an empty line yet comes back as
+   *  header_partial, with stop pointing at the field that was cut off;
+   *  feed the input from there once more of it is available. If \p at_eof
+   *  is true, the end of input terminates the header, even in the middle of
+   *  a line.
+   */
+  header_info split_header( char const * first, char const * last
+                          , std::vector<header_field> & fields
+                          , bool at_eof = true
+                          );
+
+  /**
+   *  \brief Split a header that arrives in pieces, e.g. from a socket.
+   *
+   *  Every byte is looked at once, no matter how the input is cut up. Only
+   *  a field that straddles two chunks is copied; all other fields point
+   *  into the chunk that was fed. The end of a field doesn't depend on the
+   *  comments or quoted strings in it, so the value grammars need to run
+   *  only once per field, after feed() has returned it.
+   *
+   *  The fields produced by a stream are the same split_header() finds in
+   *  the concatenated input.
+   */
+  class header_stream
+  {
+  public:
+    header_stream();
+
+    /**
+     *  Split the next chunk of input and append all fields it completes to
+     *  \p fields. Those ranges remain valid until the next call of feed(),
+     *  finish(), or reset(), as long as the chunk does.
+     *
+     *  \return header_partial if more input is needed. If the header is
+     *           complete, stop points at the start of the body within the
+     *           chunk. Once the header has been completed or found
+     *           malformed, further calls return the same status with stop
+     *           pointing at \p first.
+     */
+    header_info feed(char const * first, char const * last, std::vector<header_field> & fields);
+
+    /// Signal the end of input, which terminates a header that has no body.
+    header_status finish(std::vector<header_field> & fields);
+
+    /// Prepare for a new message. Allocated buffers are kept.
+    void reset();
+
+  private:
+    enum phase_type { line_start, blank_line, name, colon, value, done, failed };
+
+    std::size_t offset(char const * p, char const * first) const;
+    void        emit(char const * next_line, char const * first, std::vector<header_field> & fields);
+
+    phase_type          phase;
+    char const *        start;          ///< The current field, if it began in this chunk.
+    std::string         pending;        ///< The current field, if it began in an earlier chunk.
+    std::string         completed;      ///< A field that was pending until this chunk.
+    std::size_t         name_end;       ///< Offsets into the current field.
+    std::size_t         value_begin;
+    bool                cr;             ///< The byte before the current position is a CR,
+    bool                crlf;           ///< or the two bytes before it are a CRLF that ends a line.
+  };
+
+} // rfc2822
+
+#endif // RFC2822_HEADER_HPP_INCLUDED
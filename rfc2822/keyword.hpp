@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_KEYWORD_HPP_INCLUDED
+#define RFC2822_KEYWORD_HPP_INCLUDED
+
+#include "base.hpp"
+#include <boost/cstdint.hpp>
+#include <boost/preprocessor/repetition/enum.hpp>
+
+namespace rfc2822
+{
+  /**
+   *  A keyword of up to three characters packed into one integer: the
+   *  characters occupy the lower three bytes in order, the length goes into
+   *  the top byte.
+   */
+  template <unsigned char C0, unsigned char C1 = 0, unsigned char C2 = 0>
+  struct keyword_key
+  {
+    static boost::uint32_t const value =
+      static_cast<boost::uint32_t>(C2 ? 3u : C1 ? 2u : 1u) << 24 | C2 << 16 | C1 << 8 | C0;
+  };
+
+  struct keyword_entry
+  {
+    boost::uint32_t     key;            ///< 0 marks an empty slot
+    int                 value;
+  };
+
+  /**
+   *  A perfect hash table of keywords, where the hash function is
+   *  <code>(key * Multiplier) >> (32 - Bits)</code>. Multiplier has been
+   *  chosen so that no two keywords of the table collide. Derived tables
+   *  place their keywords with RFC2822_KEYWORD(), which computes the slot at
+   *  compile time; a collision shows up as a duplicate specialization.
+   */
+  template <boost::uint32_t Multiplier, unsigned Bits>
+  struct keyword_table
+  {
+    enum { size = 1u << Bits, max_length = 3u };
+
+    template <boost::uint32_t Key>
+    struct hash
+    {
+      static boost::uint32_t const value = static_cast<boost::uint32_t>(Key * Multiplier) >> (32u - Bits);
+    };
+
+    static unsigned slot_of(boost::uint32_t key)
+    {
+      return static_cast<boost::uint32_t>(key * Multiplier) >> (32u - Bits);
+    }
+  };
+
+  /**
+   *  Match the longest keyword of the table, just like a
+   *  <code>spirit::symbols<int></code> does. Characters are read through the
+   *  scanner, so nocase_d applies.
+   */
+  template <typename TableT>
+  struct keyword_parser : public spirit::parser< keyword_parser<TableT> >
+  {
+    typedef keyword_parser<TableT> self_t;
+
+    template <typename ScannerT>
+    struct result
+    {
+      typedef typename spirit::match_result<ScannerT, int>::type type;
+    };
+
+    keyword_parser() { }
+
+    static keyword_entry const * find(boost::uint32_t key)
+    {
+      keyword_entry const & e( TableT::entries[TableT::slot_of(key)] );
+      return e.key == key ? &e : 0;
+    }
+
+    template <typename ScannerT>
+    typename spirit::parser_result<self_t, ScannerT>::type
+    parse(ScannerT const & scan) const
+    {
+      typedef typename ScannerT::iterator_t iterator_t;
+
+      if (scan.at_end())
+        return scan.no_match();
+
+      iterator_t const save(scan.first);
+      iterator_t       ends[TableT::max_length];
+      boost::uint32_t  chars( 0u );
+      unsigned         len( 0u );
+      do
+      {
+        chars |= static_cast<boost::uint32_t>(static_cast<unsigned char>(*scan)) << (8u * len);
+        ++scan;
+        ends[len++] = scan.first;
+      }
+      while (len != TableT::max_length && !scan.at_end());
+
+      for (; len; --len)
+      {
+        boost::uint32_t const mask( ~boost::uint32_t(0u) >> (32u - 8u * len) );
+        if (keyword_entry const * e = find(len << 24 | (chars & mask)))
+        {
+          scan.first = ends[len - 1u];
+          return scan.create_match(len, e->value, save, scan.first);
+        }
+      }
+      scan.first = save;
+      return scan.no_match();
+    }
+  };
+
+} // rfc2822
+
+/**
+ *  Place a keyword into the slot its hash designates. Unused characters
+ *  are given as 0.
+ */
+#define RFC2822_KEYWORD(TABLE, C0, C1, C2, VALUE)                                                 \
+  template <> struct TABLE::slot< TABLE::hash< rfc2822::keyword_key<C0, C1, C2>::value >::value > \
+  {                                                                                               \
+    static boost::uint32_t const key = rfc2822::keyword_key<C0, C1, C2>::value;                   \
+    static int const value = VALUE;                                                               \
+  }
+
+#define RFC2822_KEYWORD_ENTRY(z, n, TABLE) { TABLE::slot<n>::key, TABLE::slot<n>::value }
+
+/// Define the slots of a table with SIZE entries.
+#define RFC2822_KEYWORD_TABLE(TABLE, SIZE)                              \
+  rfc2822::keyword_entry const TABLE::entries[SIZE] =                   \
+    { BOOST_PP_ENUM(SIZE, RFC2822_KEYWORD_ENTRY, TABLE) }
+
+#endif // RFC2822_KEYWORD_HPP_INCLUDED
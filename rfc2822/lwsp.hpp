@@ -13,7 +13,7 @@
 #ifndef RFC2822_LWSP_HPP_INCLUDED
 #define RFC2822_LWSP_HPP_INCLUDED
 
-#include "base.hpp"
+#include "profile.hpp"
 #include "crlf.hpp"
 
 namespace rfc2822
@@ -25,16 +25,16 @@ namespace rfc2822
     template<typename scannerT>
     struct definition
     {
-      spirit::rule<scannerT>    lwsp;
+      spirit::rule<scannerT, rule_context> lwsp;
 
       definition(lwsp_parser const &)
       {
         lwsp = spirit::lexeme_d[ +( !crlf_p >> wsp_p ) ];
 
-        BOOST_SPIRIT_DEBUG_NODE(lwsp);
+        RFC2822_DEBUG_NODE(lwsp);
       }
 
-      spirit::rule<scannerT> const & start() const { return lwsp; }
+      spirit::rule<scannerT, rule_context> const & start() const { return lwsp; }
     };
   };
 
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_MBOX_HPP_INCLUDED
+#define RFC2822_MBOX_HPP_INCLUDED
+
+#include "date.hpp"
+#include "header.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace rfc2822
+{
+  /**
+   *  \brief Find the next message of an mbox.
+   *
+   *  Messages are separated by lines that begin with <code>"From "</code>.
+   *
+   *  \return The start of the first such line that begins after \p first,
+   *          or \p last if there is none.
+   */
+  char const * next_mbox_message(char const * first, char const * last);
+
+  /**
+   *  The interesting header fields of a message. Address fields hold
+   *  canonic addr-specs, without display names and routes; To and Cc
+   *  include the members of groups. A field that is missing or doesn't
+   *  parse is left empty. Lines may end in LF or CRLF.
+   */
+  struct mbox_message
+  {
+    std::size_t                 offset;         ///< Of the "From " line, from the start of the mbox.
+    std::size_t                 size;           ///< Of the whole message, "From " line included.
+    bool                        has_date;
+    timestamp                   date;
+    std::vector<std::string>    from;
+    std::string                 sender;
+    std::vector<std::string>    to;
+    std::vector<std::string>    cc;
+
+    mbox_message() : offset(0u), size(0u), has_date(false) { }
+  };
+
+  /**
+   *  Parse the header of a message that spans <code>[first, last)</code>,
+   *  starting with its "From " line. Offset and size are left alone.
+   */
+  void parse_mbox_message(char const * first, char const * last, mbox_message & msg);
+
+  struct mbox_options
+  {
+    unsigned            threads;        ///< 0 means one per CPU.
+    std::size_t         batch_size;     ///< Messages are handed out in batches of about this many bytes.
+
+    mbox_options() : threads(0u), batch_size(256u * 1024u) { }
+  };
+
+  typedef boost::function<void (mbox_message const &)> mbox_handler;
+
+  /**
+   *  \brief Parse all messages of an mbox.
+   *
+   *  The messages are parsed by a pool of threads, which take batches of
+   *  consecutive messages as they become free. \p handler is called from
+   *  the calling thread, once for every message, in the order the messages
+   *  appear in the mbox. Only a limited number of batches is kept in
+   *  flight, so memory use doesn't depend on the size of the input. The
+   *  threads are the ones parse_address_list() uses; they are started on
+   *  first use and kept for the lifetime of the program.
+   *
+   *  Unless the library was built thread-safe, i.e. with
+   *  BOOST_SPIRIT_THREADSAFE, all messages are parsed by the calling
+   *  thread.
+   *
+   *  \return The number of messages.
+   */
+  std::size_t parse_mbox( char const * first, char const * last
+                        , mbox_handler const & handler
+                        , mbox_options const & opt = mbox_options()
+                        );
+
+  /// A file mapped into memory for reading. Throws \c std::runtime_error if
+  /// it can't be opened or mapped.
+  class mapped_file : private boost::noncopyable
+  {
+  public:
+    explicit mapped_file(char const * path);
+    ~mapped_file();
+
+    char const * begin() const { return data; }
+    char const * end() const   { return data + length; }
+
+  private:
+    char const *        data;
+    std::size_t         length;
+  };
+
+} // rfc2822
+
+#endif // RFC2822_MBOX_HPP_INCLUDED
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_PARSE_HPP_INCLUDED
+#define RFC2822_PARSE_HPP_INCLUDED
+
+#include "canonic-string.hpp"
+#include "timestamp.hpp"
+#include <string>
+
+namespace rfc2822
+{
+  struct parse_budget;
+
+  /**
+   *  \name Precompiled parsers
+   *
+   *  The parsers most programs need, compiled into the library for
+   *  <code>char const *</code> ranges with skipper_p. This header doesn't
+   *  include Spirit, so code that calls these functions instead of running
+   *  addr_spec_p or date_p itself compiles faster and doesn't carry a copy
+   *  of the grammar in every translation unit.
+   *
+   *  Leading and trailing white space and comments are skipped. If the
+   *  input matches, the parser's result is assigned to \p result;
+   *  otherwise \p result is left alone.
+   *
+   *  \return The end of the match, or \c NULL if the input doesn't match.
+   */
+  //@{
+  char const * parse_addr_spec(char const * first, char const * last, std::string & result);
+  char const * parse_mailbox(char const * first, char const * last, std::string & result);
+  char const * parse_route_addr(char const * first, char const * last, std::string & result);
+  char const * parse_date(char const * first, char const * last, timestamp & result);
+
+  /// Like parse_addr_spec(), but through addr_spec_ref_p.
+  char const * parse_addr_spec(char const * first, char const * last, canonic_string & result);
+
+  /// Like parse_mailbox(), but through mailbox_ref_p.
+  char const * parse_mailbox(char const * first, char const * last, canonic_string & result);
+
+  /**
+   *  Like the functions above, but the parse gives up once it has spent
+   *  \p budget. If they return \c NULL and <code>budget.exceeded</code> is
+   *  set, the input was too expensive to parse rather than invalid. The
+   *  budget isn't reset, so one budget can bound all addresses of a
+   *  header.
+   */
+  char const * parse_addr_spec(char const * first, char const * last, std::string & result, parse_budget & budget);
+  char const * parse_mailbox(char const * first, char const * last, std::string & result, parse_budget & budget);
+  char const * parse_route_addr(char const * first, char const * last, std::string & result, parse_budget & budget);
+  char const * parse_date(char const * first, char const * last, timestamp & result, parse_budget & budget);
+  //@}
+
+} // rfc2822
+
+#endif // RFC2822_PARSE_HPP_INCLUDED
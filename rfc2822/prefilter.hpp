@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_PREFILTER_HPP_INCLUDED
+#define RFC2822_PREFILTER_HPP_INCLUDED
+
+namespace rfc2822
+{
+  /**
+   *  \brief Tell cheaply whether addr_spec_p might match a prefix of
+   *         <code>[first, last)</code>.
+   *
+   *  The input is read once, runs of atext, qtext, ctext, and white space
+   *  with the vectorized span kernels. The function returns \c false only
+   *  if no parse can succeed, i.e. if, in front of the first "@" outside
+   *  of quoted strings and comments, there is
+   *
+   *  - no "@" at all, or no word;
+   *  - a control character or special other than ".", or an unmatched ")";
+   *  - a quoted string or comment that doesn't end;
+   *
+   *  or if the "@" isn't followed by an atom or a domain literal. Anything
+   *  else may still fail in the grammar. recognize_addr_spec() and
+   *  parse_addr_spec() call this function first, so that garbage never
+   *  enters the grammar; the overloads of parse_addr_spec() that take a
+   *  parse_budget don't, since it reads all of the input.
+   */
+  bool may_be_addr_spec(char const * first, char const * last);
+
+  /// The filter for parsers that have none: every input may match.
+  inline bool any_input(char const *, char const *)
+  {
+    return true;
+  }
+
+} // rfc2822
+
+#endif // RFC2822_PREFILTER_HPP_INCLUDED
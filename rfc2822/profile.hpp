@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_PROFILE_HPP_INCLUDED
+#define RFC2822_PROFILE_HPP_INCLUDED
+
+#include "base.hpp"
+#include <iosfwd>
+#include <boost/cstdint.hpp>
+
+// Every rule of every grammar is declared as a spirit::rule<scannerT,
+// rule_context>, and every grammar names its rules with
+// RFC2822_DEBUG_NODE(). Normally, rule_context is Spirit's default and
+// RFC2822_DEBUG_NODE() is BOOST_SPIRIT_DEBUG_NODE(), so neither costs a
+// thing. Build with RFC2822_PROFILE -- configure --enable-profile, b2
+// variant=profile -- and each named rule counts how often it runs, how
+// often it matches, and how many characters it consumes. With
+// RFC2822_PROFILE_CYCLES, which both of those define too, it also reads
+// the time stamp counter around every run. Like BOOST_SPIRIT_THREADSAFE,
+// the setting is recorded in rfc2822/config.hpp, so that library and
+// users agree on it. The counters aren't synchronized, so profile with
+// one thread.
+
+namespace rfc2822
+{
+  /// What profiling found out about one rule.
+  struct rule_profile
+  {
+    char const *        grammar;        ///< Header the rule is defined in, e.g. \c "address".
+    char const *        name;           ///< Name of the rule, e.g. \c "local_part".
+    boost::uint64_t     calls;
+    boost::uint64_t     hits;
+    boost::uint64_t     misses;         ///< Failed runs, i.e. backtracking in the caller.
+    boost::uint64_t     bytes;          ///< Characters consumed by matches.
+    boost::uint64_t     cycles;         ///< Time stamp counter ticks inside the rule, including nested rules.
+  };
+
+  /**
+   *  \brief Find the counters of a rule; \c NULL if it wasn't named.
+   *
+   *  Rules with the same name in the same header share their counters,
+   *  whichever grammar object or thread they belong to.
+   */
+  rule_profile * find_rule_profile(void const * rule);
+
+  /// Name a rule for find_rule_profile(); that's what RFC2822_DEBUG_NODE() does.
+  void register_rule_profile(void const * rule, char const * file, char const * name);
+
+  /// Print all counters, most frequently run rule first.
+  void dump_rule_profiles(std::ostream & os);
+
+  /// Set all counters to zero.
+  void reset_rule_profiles();
+
+#ifdef RFC2822_PROFILE
+
+  inline boost::uint64_t profile_clock()
+  {
+#if defined(RFC2822_PROFILE_CYCLES) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_ia32_rdtsc();
+#else
+    return 0u;
+#endif
+  }
+
+  /// Rule context that updates the rule's profile around every run.
+  struct profile_context : spirit::parser_context_base
+  {
+    typedef spirit::nil_t                                       attr_t;
+    typedef spirit::default_parser_context_base                 base_t;
+    typedef spirit::parser_context_linker<profile_context>      context_linker_t;
+
+    template <typename ParserT>
+    profile_context(ParserT const & p) : profile(find_rule_profile(&p)), start(0u) { }
+
+    template <typename ParserT, typename ScannerT>
+    void pre_parse(ParserT const &, ScannerT const &)
+    {
+      if (profile)
+      {
+        ++profile->calls;
+        start = profile_clock();
+      }
+    }
+
+    template <typename ResultT, typename ParserT, typename ScannerT>
+    ResultT & post_parse(ResultT & hit, ParserT const &, ScannerT const &)
+    {
+      if (profile)
+      {
+        profile->cycles += profile_clock() - start;
+        if (hit)
+        {
+          ++profile->hits;
+          profile->bytes += static_cast<boost::uint64_t>(hit.length());
+        }
+        else
+          ++profile->misses;
+      }
+      return hit;
+    }
+
+  private:
+    rule_profile * const        profile;
+    boost::uint64_t             start;
+  };
+
+  typedef profile_context rule_context;
+
+#  define RFC2822_DEBUG_NODE(r) ::rfc2822::register_rule_profile(&(r), __FILE__, #r)
+
+#else
+
+  typedef spirit::parser_context<> rule_context;
+
+#  define RFC2822_DEBUG_NODE(r) BOOST_SPIRIT_DEBUG_NODE(r)
+
+#endif // RFC2822_PROFILE
+
+} // rfc2822
+
+#endif // RFC2822_PROFILE_HPP_INCLUDED
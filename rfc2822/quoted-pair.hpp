@@ -13,7 +13,7 @@
 #ifndef RFC2822_QUOTED_PAIR_HPP_INCLUDED
 #define RFC2822_QUOTED_PAIR_HPP_INCLUDED
 
-#include "base.hpp"
+#include "profile.hpp"
 
 namespace rfc2822
 {
@@ -24,16 +24,16 @@ namespace rfc2822
     template<typename scannerT>
     struct definition
     {
-      spirit::rule<scannerT>  quoted_pair;
+      spirit::rule<scannerT, rule_context> quoted_pair;
 
       definition(quoted_pair_parser const &)
       {
         using namespace spirit;
         quoted_pair = lexeme_d[ ch_p('\\') >> anychar_p ];
-        BOOST_SPIRIT_DEBUG_NODE(quoted_pair);
+        RFC2822_DEBUG_NODE(quoted_pair);
       }
 
-      spirit::rule<scannerT> const & start() const { return quoted_pair; }
+      spirit::rule<scannerT, rule_context> const & start() const { return quoted_pair; }
     };
   };
 
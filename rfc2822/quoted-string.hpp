@@ -15,6 +15,7 @@
 
 #include "lwsp.hpp"
 #include "quoted-pair.hpp"
+#include "char-class.hpp"
 
 namespace rfc2822
 {
@@ -25,9 +26,9 @@ namespace rfc2822
     template<typename scannerT>
     struct definition
     {
-      spirit::rule<scannerT>    quoted_string;
-      spirit::subrule<0>        qstring;
-      spirit::subrule<1>        qtext;
+      spirit::rule<scannerT, rule_context>    quoted_string;
+      spirit::subrule<0>                      qstring;
+      spirit::subrule<1>                      qtext;
 
       definition(quoted_string_parser const &)
       {
@@ -35,13 +36,13 @@ namespace rfc2822
         quoted_string =
           lexeme_d
           [ qstring  = ch_p('"') >> *( qtext | quoted_pair_p ) >> '"'
-          , qtext    = +( (anychar_p - (ch_p('"') | '\\' | cr_p)) | lwsp_p )
+          , qtext    = +( qtext_run_p | lwsp_p )
           ];
 
-        BOOST_SPIRIT_DEBUG_NODE(quoted_string);
+        RFC2822_DEBUG_NODE(quoted_string);
       }
 
-      spirit::rule<scannerT> const & start() const { return quoted_string; }
+      spirit::rule<scannerT, rule_context> const & start() const { return quoted_string; }
     };
   };
 
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_RECOGNIZE_HPP_INCLUDED
+#define RFC2822_RECOGNIZE_HPP_INCLUDED
+
+#include "skipper.hpp"
+
+namespace rfc2822
+{
+  /**
+   *  \brief Match \p p against <code>[first, last)</code> with all
+   *         semantic actions disabled.
+   *
+   *  The parser runs under <code>no_actions_d</code>, so it uses the very
+   *  same grammar as with actions and accepts exactly the same language,
+   *  but it builds no strings and fills no time stamps. Leading and trailing
+   *  white space and comments are skipped.
+   *
+   *  \return The end of the match, or \c NULL if \p p doesn't match.
+   */
+  template <typename ParserT>
+  inline char const * recognize(ParserT const & p, char const * first, char const * last)
+  {
+    spirit::parse_info<> const r = spirit::parse(first, last, spirit::no_actions_d[p], skipper_p);
+    return r.hit ? r.stop : 0;
+  }
+
+  /**
+   *  \name Recognizers
+   *
+   *  Precompiled instances of recognize() for the parsers that have
+   *  semantic actions. They never throw and don't allocate memory once the
+   *  grammar has been used for the first time. Should setting up the
+   *  grammar fail for lack of memory, the input is rejected.
+   */
+  //@{
+  char const * recognize_addr_spec(char const * first, char const * last) throw();
+  char const * recognize_mailbox(char const * first, char const * last) throw();
+  char const * recognize_route_addr(char const * first, char const * last) throw();
+  char const * recognize_date(char const * first, char const * last) throw();
+  //@}
+
+} // rfc2822
+
+#endif // RFC2822_RECOGNIZE_HPP_INCLUDED
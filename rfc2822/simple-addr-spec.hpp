@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_SIMPLE_ADDR_SPEC_HPP_INCLUDED
+#define RFC2822_SIMPLE_ADDR_SPEC_HPP_INCLUDED
+
+#include "budget.hpp"
+
+namespace rfc2822
+{
+  /**
+   *  A single-pass, table-driven scanner for the <code>dot-atom "@"
+   *  dot-atom</code> form of an address. The scanner matches only if the
+   *  full addr_spec_p grammar would match exactly the same input, so the
+   *  canonic address is the matched text itself. Anything out of the
+   *  ordinary -- comments, folding, quoted strings, domain literals -- makes
+   *  the scanner fail without consuming input, so that the caller can fall
+   *  back to the full grammar.
+   */
+  struct simple_addr_spec_parser : public spirit::parser<simple_addr_spec_parser>
+  {
+    typedef simple_addr_spec_parser self_t;
+
+    simple_addr_spec_parser() { }
+
+    /// Character classes.
+    enum { atext, dot, at, cfws, other, classes };
+
+    /// Scanner states. Everything from \c accept upwards terminates the scan.
+    enum { start, local_atom, local_dot, domain_start, domain_atom, domain_dot, accept, fallback };
+
+    static unsigned char const char_class[256];
+    static unsigned char const transition[accept][classes];
+
+    template <typename ScannerT>
+    typename spirit::parser_result<self_t, ScannerT>::type
+    parse(ScannerT const & scan) const
+    {
+      typedef typename ScannerT::iterator_t iterator_t;
+
+      if (scan.at_end())        // also gives the skipper a chance to run
+        return scan.no_match();
+      iterator_t const save(scan.first);
+      iterator_t const last(budget_end(scan));
+      iterator_t it(save);
+      std::size_t len( 0 );
+      unsigned state( start );
+      for (; it != last; ++it, ++len)
+      {
+        state = transition[state][char_class[static_cast<unsigned char>(*it)]];
+        if (state >= accept) break;
+      }
+      if (state == domain_atom)
+        state = accept;         // end of input
+      if (!charge(scan, len) || state != accept)
+        return scan.no_match();
+      scan.first = it;
+      return scan.create_match(len, spirit::nil_t(), save, it);
+    }
+  };
+
+} // rfc2822
+
+#endif // RFC2822_SIMPLE_ADDR_SPEC_HPP_INCLUDED
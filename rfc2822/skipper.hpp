@@ -15,25 +15,88 @@
 
 #include "lwsp.hpp"
 #include "comment.hpp"
+#include "char-class.hpp"
+#include "budget.hpp"
 
 namespace rfc2822
 {
-  struct skipper : public spirit::grammar<skipper>
+  /**
+   *  Equivalent to <code>lwsp_p | comment_p</code>, but the first character
+   *  decides which alternative can match, so that the common case -- no
+   *  white space at all -- costs a single comparison. White space is
+   *  consumed inline; only "(" enters comment_p.
+   */
+  struct skipper : public spirit::parser<skipper>
   {
+    typedef skipper self_t;
+
     skipper() { }
 
-    template<typename scannerT>
-    struct definition
+    template <typename IteratorT>
+    static IteratorT wsp_end(IteratorT first, IteratorT last)
+    {
+      while (first != last && (*first == ' ' || *first == '\t'))
+        ++first;
+      return first;
+    }
+
+    static char const * wsp_end(char const * first, char const * last)
     {
-      spirit::rule<scannerT>    top;
+      return first + wsp_span(first, last);
+    }
 
-      definition(skipper const &)
+    /// Consume <code>1*([CRLF] WSP)</code> the way lwsp_p does, or return
+    /// \c first if there is none.
+    template <typename IteratorT>
+    static IteratorT lwsp_end(IteratorT first, IteratorT const & last)
+    {
+      for (;;)
       {
-        top = lwsp_p | comment_p;
+        if (first == last)
+          return first;
+        if (*first == ' ' || *first == '\t')
+        {
+          first = wsp_end(first, last);
+          continue;
+        }
+        if (*first != '\r')
+          return first;
+        IteratorT lf( first );
+        if (++lf == last || *lf != '\n')
+          return first;
+        IteratorT ws( lf );
+        if (++ws == last || (*ws != ' ' && *ws != '\t'))
+          return first;
+        first = ws;
       }
+    }
 
-      spirit::rule<scannerT> const & start() const { return top; }
-    };
+    template <typename ScannerT>
+    typename spirit::parser_result<self_t, ScannerT>::type
+    parse(ScannerT const & scan) const
+    {
+      typedef typename ScannerT::iterator_t iterator_t;
+
+      if (scan.at_end())
+        return scan.no_match();
+      switch (*scan.first)
+      {
+        case ' ': case '\t': case '\r':
+        {
+          iterator_t const save(scan.first);
+          iterator_t const stop(lwsp_end(save, budget_end(scan)));
+          std::size_t const len( std::distance(save, stop) );
+          if (!len || !charge(scan, len))
+            return scan.no_match();
+          scan.first = stop;
+          return scan.create_match(len, spirit::nil_t(), save, stop);
+        }
+        case '(':
+          return comment_p.parse(scan);
+        default:
+          return scan.no_match();
+      }
+    }
   };
 
 } // rfc2822
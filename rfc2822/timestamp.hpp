@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_TIMESTAMP_HPP_INCLUDED
+#define RFC2822_TIMESTAMP_HPP_INCLUDED
+
+#include <boost/compatibility/cpp_c_headers/ctime>
+#include <boost/compatibility/cpp_c_headers/cstring>
+#include <boost/cstdint.hpp>
+#include <ostream>
+
+namespace rfc2822
+{
+  struct timestamp : public std::tm
+  {
+    timestamp()    { std::memset(this, 0, sizeof(*this)); }
+    int tzoffset;
+  };
+
+  inline std::ostream & operator<< (std::ostream & os, timestamp const & ts)
+  {
+    return os << std::asctime(&ts);
+  }
+
+  /**
+   *  Number of days since 1970-01-01 in the proleptic Gregorian calendar.
+   *  The month is 1-based; days outside of the month's range carry over
+   *  into the neighboring months, just like with \c std::mktime.
+   */
+  inline boost::int64_t days_from_civil(boost::int64_t y, unsigned m, boost::int64_t d)
+  {
+    y -= m <= 2;
+    boost::int64_t const era( (y >= 0 ? y : y - 399) / 400 );
+    unsigned const yoe( static_cast<unsigned>(y - era * 400) );           // [0, 399]
+    unsigned const doy( (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 );         // [0, 365], without the day
+    unsigned const doe( yoe * 365 + yoe / 4 - yoe / 100 + doy );          // [0, 146096]
+    return era * 146097 + static_cast<boost::int64_t>(doe) + (d - 1) - 719468;
+  }
+
+  /**
+   *  Convert the result of date_p into seconds since the epoch in UTC.
+   *  Unlike \c std::mktime, this function does not depend on the time zone
+   *  of the process, doesn't take any locks, and cannot fail.
+   */
+  inline boost::int64_t epoch_seconds(timestamp const & ts)
+  {
+    boost::int64_t const days( days_from_civil( static_cast<boost::int64_t>(ts.tm_year) + 1900
+                                              , static_cast<unsigned>(ts.tm_mon) + 1u
+                                              , ts.tm_mday
+                                              ) );
+    return ((days * 24 + ts.tm_hour) * 60 + ts.tm_min) * 60 + ts.tm_sec - ts.tzoffset;
+  }
+
+} // rfc2822
+
+#endif // RFC2822_TIMESTAMP_HPP_INCLUDED
@@ -25,15 +25,15 @@ namespace rfc2822
     template<typename scannerT>
     struct definition
     {
-      spirit::rule<scannerT>    word;
+      spirit::rule<scannerT, rule_context> word;
 
       definition(word_parser const &)
       {
         word = atom_p | quoted_string_p;
-        BOOST_SPIRIT_DEBUG_NODE(word);
+        RFC2822_DEBUG_NODE(word);
       }
 
-      spirit::rule<scannerT> const & start() const { return word; }
+      spirit::rule<scannerT, rule_context> const & start() const { return word; }
     };
   };
 
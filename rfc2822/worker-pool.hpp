@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_WORKER_POOL_HPP_INCLUDED
+#define RFC2822_WORKER_POOL_HPP_INCLUDED
+
+#include <rfc2822/config.hpp>
+
+#ifdef BOOST_SPIRIT_THREADSAFE
+
+#include <cstddef>
+#include <deque>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace rfc2822
+{
+  namespace detail
+  {
+    /**
+     *  A batch of tasks for the library's worker threads, which
+     *  parse_address_list() and parse_mbox() share.
+     *
+     *  The workers are started the first time a task_group needs them and
+     *  run until the program ends; there are as many as the largest group
+     *  has asked for. Every worker calls prepare_parsers() before it takes
+     *  its first task, so the grammar definitions are built once per
+     *  worker rather than once per call.
+     *
+     *  Tasks must not throw. wait() runs the tasks no worker has taken yet
+     *  on the calling thread, so a group never waits for the pool to get
+     *  around to it.
+     */
+    class task_group : private boost::noncopyable
+    {
+    public:
+      typedef boost::function<void ()> task;
+
+      /// Make sure the pool has at least \p workers threads.
+      explicit task_group(unsigned workers);
+
+      /// Calls wait().
+      ~task_group();
+
+      void run(task const & t);
+
+      /// Return once every task given to run() has finished.
+      void wait();
+
+    private:
+      friend class worker_pool;
+
+      std::deque<task>                  pending;
+      std::size_t                       running;
+      boost::condition_variable         idle;
+    };
+  }
+
+} // rfc2822
+
+#endif // BOOST_SPIRIT_THREADSAFE
+
+#endif // RFC2822_WORKER_POOL_HPP_INCLUDED
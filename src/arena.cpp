@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/arena.hpp"
+#include <boost/cstdint.hpp>
+
+#ifdef BOOST_SPIRIT_THREADSAFE
+#  include <boost/thread/tss.hpp>
+#endif
+
+using rfc2822::arena;
+
+// Blocks from operator new start with this header, padded to the
+// alignment, and are chained newest first.
+
+struct arena::block
+{
+  block *       prev;
+};
+
+namespace
+{
+  char * align(char * p)
+  {
+    boost::uintptr_t const n( reinterpret_cast<boost::uintptr_t>(p) );
+    return p + ((arena::alignment - n % arena::alignment) % arena::alignment);
+  }
+
+  char * begin_of(void * buffer, std::size_t size)
+  {
+    return buffer && size ? align(static_cast<char *>(buffer)) : 0;
+  }
+
+  char * end_of(void * buffer, std::size_t size)
+  {
+    char * const first( begin_of(buffer, size) );
+    char * const last( static_cast<char *>(buffer) + size );
+    return first && first < last ? last : first;
+  }
+
+#ifdef BOOST_SPIRIT_THREADSAFE
+  void keep(arena *) { }
+  boost::thread_specific_ptr<arena> current_arena(&keep);
+#else
+  struct
+  {
+    arena * ptr;
+    arena * get() const         { return ptr; }
+    void reset(arena * a)       { ptr = a; }
+  } current_arena = { 0 };
+#endif
+}
+
+arena::arena(std::size_t bsize)
+  : buffer_begin(0), buffer_end(0), next(0), end(0), blocks(0), block_size(bsize)
+{
+}
+
+arena::arena(void * buffer, std::size_t size, std::size_t bsize)
+  : buffer_begin(begin_of(buffer, size)), buffer_end(end_of(buffer, size))
+  , next(buffer_begin), end(buffer_end), blocks(0), block_size(bsize)
+{
+}
+
+void arena::grow(std::size_t n)
+{
+  std::size_t const header_size( (sizeof(block) + alignment - 1u) & ~std::size_t(alignment - 1u) );
+  std::size_t const size( n > block_size ? n : block_size );
+  block * const b( static_cast<block *>(::operator new(header_size + size)) );
+  b->prev = blocks;
+  blocks  = b;
+  next    = reinterpret_cast<char *>(b) + header_size;
+  end     = next + size;
+}
+
+void arena::release()
+{
+  while (blocks)
+  {
+    block * const b( blocks );
+    blocks = b->prev;
+    ::operator delete(b);
+  }
+  next = buffer_begin;
+  end  = buffer_end;
+}
+
+arena * arena::current()
+{
+  return current_arena.get();
+}
+
+void arena::make_current(arena * a)
+{
+  current_arena.reset(a);
+}
@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/char-class.hpp"
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#  define RFC2822_SSE2_KERNELS
+#endif
+
+#if defined(RFC2822_SSE2_KERNELS) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  include <immintrin.h>
+#  define RFC2822_AVX2_KERNELS
+#  define RFC2822_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+using namespace rfc2822;
+
+// Bit 0: atext, bit 1: qtext, bit 2: ctext, bit 3: WSP.
+
+unsigned char const rfc2822::char_class_table[256] =
+  {
+    6, 6, 6, 6, 6, 6, 6, 6, 6,14, 6, 6, 6, 0, 6, 6,   // 00-0F
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,   // 10-1F
+   14, 7, 4, 7, 7, 7, 7, 7, 2, 2, 7, 7, 6, 7, 6, 7,   // 20-2F
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 6, 6, 6, 7, 6, 7,   // 30-3F
+    6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,   // 40-4F
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 6, 0, 6, 7, 7,   // 50-5F
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,   // 60-6F
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 6,   // 70-7F
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,   // 80-8F
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,   // 90-9F
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,   // A0-AF
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,   // B0-BF
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,   // C0-CF
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,   // D0-DF
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,   // E0-EF
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7    // F0-FF
+  };
+
+namespace
+{
+  template <int ClassT>
+  std::size_t span_scalar(char const * first, char const * last)
+  {
+    char const * p = first;
+    while (p != last && (char_class_table[static_cast<unsigned char>(*p)] & ClassT))
+      ++p;
+    return p - first;
+  }
+
+#ifdef RFC2822_SSE2_KERNELS
+
+  // Each class knows how to compute a bit mask of the bytes in a vector
+  // that do not belong to it.
+
+  inline __m128i eq(__m128i v, char c) { return _mm_cmpeq_epi8(v, _mm_set1_epi8(c)); }
+
+  struct atext_kernel
+  {
+    enum { bit = atext_class };
+
+    static unsigned reject(__m128i v)
+    {
+      __m128i r = _mm_cmpeq_epi8(_mm_and_si128(v, _mm_set1_epi8(char(0xE0))), _mm_setzero_si128());
+      r = _mm_or_si128(r, _mm_or_si128(eq(v, ' '),  eq(v, '\x7F')));
+      r = _mm_or_si128(r, _mm_or_si128(eq(v, '('),  eq(v, ')')));
+      r = _mm_or_si128(r, _mm_or_si128(eq(v, '<'),  eq(v, '>')));
+      r = _mm_or_si128(r, _mm_or_si128(eq(v, '@'),  eq(v, ',')));
+      r = _mm_or_si128(r, _mm_or_si128(eq(v, ';'),  eq(v, ':')));
+      r = _mm_or_si128(r, _mm_or_si128(eq(v, '\\'), eq(v, '"')));
+      r = _mm_or_si128(r, _mm_or_si128(eq(v, '.'),  eq(v, '[')));
+      r = _mm_or_si128(r, eq(v, ']'));
+      return _mm_movemask_epi8(r);
+    }
+
+#ifdef RFC2822_AVX2_KERNELS
+    // Look up both nibbles of every byte: lo_table has bit n set for each
+    // low nibble that is rejected in combination with the high nibble n,
+    // hi_table maps the high nibble n to bit n. Bytes >= 0x80 are atext.
+    RFC2822_TARGET_AVX2 static unsigned reject(__m256i v)
+    {
+      __m256i const lo_table = _mm256_setr_epi8
+        ( 0x17, 0x03, 0x07, 0x03, 0x03, 0x03, 0x03, 0x03, 0x07, 0x07, 0x0B, 0x2B, 0x2F, 0x23, 0x0F, char(0x83)
+        , 0x17, 0x03, 0x07, 0x03, 0x03, 0x03, 0x03, 0x03, 0x07, 0x07, 0x0B, 0x2B, 0x2F, 0x23, 0x0F, char(0x83)
+        );
+      __m256i const hi_table = _mm256_setr_epi8
+        ( 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, char(0x80), 0, 0, 0, 0, 0, 0, 0, 0
+        , 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, char(0x80), 0, 0, 0, 0, 0, 0, 0, 0
+        );
+      __m256i const nibble = _mm256_set1_epi8(0x0F);
+      __m256i const lo = _mm256_shuffle_epi8(lo_table, _mm256_and_si256(v, nibble));
+      __m256i const hi = _mm256_shuffle_epi8(hi_table, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+      __m256i const ok = _mm256_cmpeq_epi8(_mm256_and_si256(lo, hi), _mm256_setzero_si256());
+      return ~unsigned(_mm256_movemask_epi8(ok));
+    }
+#endif
+  };
+
+  struct qtext_kernel
+  {
+    enum { bit = qtext_class };
+
+    static unsigned reject(__m128i v)
+    {
+      return _mm_movemask_epi8(_mm_or_si128(eq(v, '"'), _mm_or_si128(eq(v, '\\'), eq(v, '\r'))));
+    }
+
+#ifdef RFC2822_AVX2_KERNELS
+    RFC2822_TARGET_AVX2 static unsigned reject(__m256i v)
+    {
+      __m256i const r = _mm256_or_si256( _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))
+                                       , _mm256_or_si256( _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))
+                                                        , _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))
+                                                        ));
+      return _mm256_movemask_epi8(r);
+    }
+#endif
+  };
+
+  struct ctext_kernel
+  {
+    enum { bit = ctext_class };
+
+    static unsigned reject(__m128i v)
+    {
+      return _mm_movemask_epi8(_mm_or_si128( _mm_or_si128(eq(v, '('), eq(v, ')'))
+                                           , _mm_or_si128(eq(v, '\\'), eq(v, '\r'))
+                                           ));
+    }
+
+#ifdef RFC2822_AVX2_KERNELS
+    RFC2822_TARGET_AVX2 static unsigned reject(__m256i v)
+    {
+      __m256i const r = _mm256_or_si256( _mm256_or_si256( _mm256_cmpeq_epi8(v, _mm256_set1_epi8('('))
+                                                        , _mm256_cmpeq_epi8(v, _mm256_set1_epi8(')'))
+                                                        )
+                                       , _mm256_or_si256( _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))
+                                                        , _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))
+                                                        ));
+      return _mm256_movemask_epi8(r);
+    }
+#endif
+  };
+
+  struct wsp_kernel
+  {
+    enum { bit = wsp_class };
+
+    static unsigned reject(__m128i v)
+    {
+      return ~_mm_movemask_epi8(_mm_or_si128(eq(v, ' '), eq(v, '\t'))) & 0xFFFFu;
+    }
+
+#ifdef RFC2822_AVX2_KERNELS
+    RFC2822_TARGET_AVX2 static unsigned reject(__m256i v)
+    {
+      __m256i const r = _mm256_or_si256( _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '))
+                                       , _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))
+                                       );
+      return ~unsigned(_mm256_movemask_epi8(r));
+    }
+#endif
+  };
+
+  template <typename KernelT>
+  std::size_t span_sse2(char const * first, char const * last)
+  {
+    char const * p = first;
+    for (; last - p >= 16; p += 16)
+    {
+      unsigned const mask = KernelT::reject(_mm_loadu_si128(reinterpret_cast<__m128i const *>(p)));
+      if (mask)
+        return (p - first) + __builtin_ctz(mask);
+    }
+    return (p - first) + span_scalar<KernelT::bit>(p, last);
+  }
+
+#ifdef RFC2822_AVX2_KERNELS
+  template <typename KernelT>
+  RFC2822_TARGET_AVX2 std::size_t span_avx2(char const * first, char const * last)
+  {
+    char const * p = first;
+    for (; last - p >= 32; p += 32)
+    {
+      unsigned const mask = KernelT::reject(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(p)));
+      if (mask)
+        return (p - first) + __builtin_ctz(mask);
+    }
+    return (p - first) + span_sse2<KernelT>(p, last);
+  }
+#endif
+
+#endif // RFC2822_SSE2_KERNELS
+
+  span_kernels const scalar_kernels =
+    { &span_scalar<atext_class>
+    , &span_scalar<qtext_class>
+    , &span_scalar<ctext_class>
+    , &span_scalar<wsp_class>
+    };
+
+#ifdef RFC2822_SSE2_KERNELS
+  span_kernels const sse2_kernels =
+    { &span_sse2<atext_kernel>
+    , &span_sse2<qtext_kernel>
+    , &span_sse2<ctext_kernel>
+    , &span_sse2<wsp_kernel>
+    };
+#endif
+
+#ifdef RFC2822_AVX2_KERNELS
+  span_kernels const avx2_kernels =
+    { &span_avx2<atext_kernel>
+    , &span_avx2<qtext_kernel>
+    , &span_avx2<ctext_kernel>
+    , &span_avx2<wsp_kernel>
+    };
+#endif
+
+  span_kernels const * select_best_kernels()
+  {
+    span_kernels const * k;
+    if ((k = get_span_kernels(simd_avx2))) return k;
+    if ((k = get_span_kernels(simd_sse2))) return k;
+    return &scalar_kernels;
+  }
+}
+
+span_kernels const * rfc2822::get_span_kernels(simd_level level)
+{
+  switch (level)
+  {
+    case simd_none:
+      return &scalar_kernels;
+
+#ifdef RFC2822_SSE2_KERNELS
+    case simd_sse2:
+      return &sse2_kernels;
+#endif
+
+#ifdef RFC2822_AVX2_KERNELS
+    case simd_avx2:
+      return __builtin_cpu_supports("avx2") ? &avx2_kernels : 0;
+#endif
+
+    default:
+      return 0;
+  }
+}
+
+span_kernels const & rfc2822::best_span_kernels()
+{
+  static span_kernels const * const best = select_best_kernels();
+  return *best;
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/domain-table.hpp"
+#include <stdexcept>
+#include <boost/assert.hpp>
+
+#ifdef BOOST_SPIRIT_THREADSAFE
+#  include <boost/thread/mutex.hpp>
+#endif
+
+using rfc2822::domain_table;
+using rfc2822::domain_id;
+
+// Every shard is an open-addressing hash table with linear probing, whose
+// slots point to immutable entries. A slot goes from NULL to its entry
+// exactly once, so a reader that finds NULL has seen the end of the probe
+// sequence. A shard grows by copying its slots into a table twice the size
+// and publishing that; the old tables stay around until the domain_table
+// goes away, because readers may still be probing them. The entries are
+// also filed by ID, in chunks that are allocated as needed and never move.
+// An ID is counted in published only once its entry has been filed, so
+// every ID up to size() can be looked up.
+
+struct domain_table::entry
+{
+  boost::uint64_t       hash;
+  domain_id             id;
+  std::string           name;
+};
+
+struct domain_table::slots
+{
+  std::size_t const                                     mask;
+  boost::scoped_array< boost::atomic<entry const *> >   slot;
+  slots * const                                         previous;
+
+  slots(std::size_t size, slots * prev)
+    : mask(size - 1u), slot(new boost::atomic<entry const *>[size]), previous(prev)
+  {
+    for (std::size_t i = 0; i != size; ++i)
+      slot[i].store(0, boost::memory_order_relaxed);
+  }
+
+  /// Add an entry that isn't in the table yet; the caller holds the shard's lock.
+  void insert(entry const * e)
+  {
+    std::size_t i( static_cast<std::size_t>(e->hash >> shard_bits) & mask );
+    while (slot[i].load(boost::memory_order_relaxed))
+      i = (i + 1u) & mask;
+    slot[i].store(e, boost::memory_order_release);
+  }
+};
+
+struct domain_table::shard
+{
+#ifdef BOOST_SPIRIT_THREADSAFE
+  typedef boost::mutex                  mutex_type;
+#else
+  struct mutex_type
+  {
+    struct scoped_lock
+    {
+      explicit scoped_lock(mutex_type &) { }
+    };
+  };
+#endif
+
+  enum { initial_size = 16 };
+
+  mutex_type                    mutex;
+  boost::atomic<slots *>        table;
+  std::size_t                   size;           ///< Guarded by the mutex.
+
+  shard() : table(new slots(initial_size, 0)), size(0u) { }
+
+  ~shard()
+  {
+    slots * t( table.load(boost::memory_order_relaxed) );
+    for (std::size_t i = 0; i <= t->mask; ++i)
+      delete t->slot[i].load(boost::memory_order_relaxed);
+    while (t)
+    {
+      slots * const prev( t->previous );
+      delete t;
+      t = prev;
+    }
+  }
+};
+
+domain_id const domain_table::no_domain;
+boost::uint64_t const domain_table::hash_seed;
+
+namespace
+{
+  bool equal_folded(std::string const & name, char const * first, char const * last)
+  {
+    if (name.size() != static_cast<std::size_t>(last - first))
+      return false;
+    for (std::string::const_iterator i = name.begin(); first != last; ++i, ++first)
+      if (*i != domain_table::fold(*first))
+        return false;
+    return true;
+  }
+}
+
+domain_table::domain_table()
+  : shard_table(new shard[shards]), count(0u), published(0u), chunks(new boost::atomic<entry_slot *>[max_chunks])
+{
+  for (std::size_t i = 0; i != max_chunks; ++i)
+    chunks[i].store(0, boost::memory_order_relaxed);
+}
+
+domain_table::~domain_table()
+{
+  for (std::size_t i = 0; i != max_chunks; ++i)
+    delete[] chunks[i].load(boost::memory_order_relaxed);
+}
+
+boost::uint64_t domain_table::hash(char const * first, char const * last)
+{
+  boost::uint64_t h( hash_seed );
+  for (; first != last; ++first)
+    h = hash_step(h, *first);
+  return h;
+}
+
+domain_id domain_table::find(char const * first, char const * last, boost::uint64_t h) const
+{
+  slots const * const t( shard_table[h & (shards - 1u)].table.load(boost::memory_order_acquire) );
+  for (std::size_t i = static_cast<std::size_t>(h >> shard_bits) & t->mask; ; i = (i + 1u) & t->mask)
+  {
+    entry const * const e( t->slot[i].load(boost::memory_order_acquire) );
+    if (!e)
+      return no_domain;
+    if (e->hash == h && equal_folded(e->name, first, last))
+      return e->id;
+  }
+}
+
+domain_id domain_table::insert(char const * first, char const * last, boost::uint64_t h)
+{
+  shard & s( shard_table[h & (shards - 1u)] );
+  shard::mutex_type::scoped_lock lock(s.mutex);
+  domain_id const known( find(first, last, h) );        // inserted while we waited
+  if (known)
+    return known;
+
+  entry * const e( new entry );
+  e->hash = h;
+  e->name.reserve(static_cast<std::size_t>(last - first));
+  for (; first != last; ++first)
+    e->name += fold(*first);
+
+  // The count is shared by all shards, so the ID is taken before it is
+  // checked; one that is past the end is given back.
+
+  std::size_t const n( count.fetch_add(1u, boost::memory_order_relaxed) );
+  if (n >= std::size_t(max_chunks) * chunk_size)
+  {
+    count.fetch_sub(1u, boost::memory_order_relaxed);
+    delete e;
+    throw std::length_error("rfc2822::domain_table is full");
+  }
+  e->id = static_cast<domain_id>(n + 1u);
+  publish(e);
+
+  slots * t( s.table.load(boost::memory_order_relaxed) );
+  if (2u * (s.size + 1u) > t->mask + 1u)
+  {
+    slots * const bigger( new slots(2u * (t->mask + 1u), t) );
+    for (std::size_t i = 0; i <= t->mask; ++i)
+      if (entry const * const old = t->slot[i].load(boost::memory_order_relaxed))
+        bigger->insert(old);
+    s.table.store(bigger, boost::memory_order_release);
+    t = bigger;
+  }
+  t->insert(e);
+  ++s.size;
+  return e->id;
+}
+
+void domain_table::publish(entry const * e)
+{
+  std::size_t const n( e->id - 1u );
+  boost::atomic<entry_slot *> & chunk( chunks[n >> chunk_bits] );
+  entry_slot * c( chunk.load(boost::memory_order_acquire) );
+  if (!c)
+  {
+    entry_slot * const fresh( new entry_slot[chunk_size] );
+    for (std::size_t i = 0; i != chunk_size; ++i)
+      fresh[i].store(0, boost::memory_order_relaxed);
+    if (chunk.compare_exchange_strong(c, fresh, boost::memory_order_acq_rel))
+      c = fresh;
+    else
+      delete[] fresh;                                   // another shard was first
+  }
+  c[n & (chunk_size - 1u)].store(e);
+
+  // IDs are handed out in one order and filed in another, since every
+  // shard has a lock of its own. Whoever files the entry right after the
+  // published ones advances the counter past all entries that are filed.
+  // The slots are stored and loaded sequentially consistent: of two
+  // threads that file neighbouring entries, at least one sees the other's.
+
+  std::size_t p( published.load() );
+  while (p != std::size_t(max_chunks) * chunk_size)
+  {
+    entry_slot const * const next( chunks[p >> chunk_bits].load() );
+    if (!next || !next[p & (chunk_size - 1u)].load())
+      break;
+    if (published.compare_exchange_weak(p, p + 1u))
+      ++p;
+  }
+}
+
+std::string const & domain_table::name(domain_id id) const
+{
+  BOOST_ASSERT(id != no_domain);
+  std::size_t const n( id - 1u );
+  entry_slot const * const c( chunks[n >> chunk_bits].load(boost::memory_order_acquire) );
+  BOOST_ASSERT(c && c[n & (chunk_size - 1u)].load(boost::memory_order_relaxed));
+  return c[n & (chunk_size - 1u)].load(boost::memory_order_acquire)->name;
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/date.hpp"
+
+rfc2822::fixed_date_parser const rfc2822::fixed_date_p;
+
+using rfc2822::timestamp;
+using rfc2822::keyword_entry;
+using boost::uint64_t;
+using boost::uint32_t;
+
+namespace
+{
+  // Assemble eight bytes in little-endian order, so that byte i of the
+  // input ends up in bits [8i, 8i+8) no matter what the host is like.
+  // Compilers turn this into a single load on little-endian machines.
+
+  inline uint64_t load8(char const * p)
+  {
+    unsigned char const * const u = reinterpret_cast<unsigned char const *>(p);
+    return  static_cast<uint64_t>(u[0])        | static_cast<uint64_t>(u[1]) <<  8
+         |  static_cast<uint64_t>(u[2]) << 16  | static_cast<uint64_t>(u[3]) << 24
+         |  static_cast<uint64_t>(u[4]) << 32  | static_cast<uint64_t>(u[5]) << 40
+         |  static_cast<uint64_t>(u[6]) << 48  | static_cast<uint64_t>(u[7]) << 56;
+  }
+
+  // Setting bit 5 maps upper- and lower-case letters -- and nothing else --
+  // to the lower-case letter, so that the keyword tables can be searched
+  // case-insensitively.
+
+  inline int lookup3(keyword_entry const * (*find)(uint32_t), char const * p)
+  {
+    unsigned char const * const u = reinterpret_cast<unsigned char const *>(p);
+    keyword_entry const * const e( find( 3u << 24
+                                       | (u[2] | 0x20u) << 16
+                                       | (u[1] | 0x20u) <<  8
+                                       | (u[0] | 0x20u)
+                                       ) );
+    return e ? e->value : -1;
+  }
+
+  inline bool is_digit(char c)
+  {
+    return static_cast<unsigned char>(c - '0') < 10u;
+  }
+
+  // A word template: 'D' marks a digit, '?' a byte checked elsewhere, and
+  // everything else a literal that must match exactly.
+
+  struct word_layout
+  {
+    uint64_t digit_mask;        // 0xFF on digits
+    uint64_t literal_mask;      // 0xFF on literals
+    uint64_t literal;           // the expected literals
+
+    explicit word_layout(char const * layout) : digit_mask(0u), literal_mask(0u), literal(0u)
+    {
+      for (unsigned i = 0; i != 8u; ++i)
+      {
+        uint64_t const byte( static_cast<uint64_t>(0xFFu) << (8u * i) );
+        if (layout[i] == 'D')
+          digit_mask |= byte;
+        else if (layout[i] != '?')
+        {
+          literal_mask |= byte;
+          literal      |= static_cast<uint64_t>(static_cast<unsigned char>(layout[i])) << (8u * i);
+        }
+      }
+    }
+
+    /// Verify the word, and return the digits converted to their values
+    /// with all other bytes cleared; or ~0 if the word doesn't fit.
+    uint64_t digits(uint64_t w) const
+    {
+      uint64_t const ones( ~uint64_t(0u) / 0xFFu );
+      uint64_t const d( w & digit_mask );
+      bool const ok( (w & literal_mask) == literal
+                   && (d & (digit_mask & ones * 0xF0u)) == (digit_mask & ones * 0x30u)
+                   && ((d + (digit_mask & ones * 0x06u)) & (digit_mask & ones * 0xF0u)) == (digit_mask & ones * 0x30u)
+                   );
+      return ok ? d - (digit_mask & ones * 0x30u) : ~uint64_t(0u);
+    }
+  };
+
+  /// Combine every digit with its successor: byte i becomes 10*d[i] + d[i+1].
+  inline uint64_t pairs(uint64_t d)
+  {
+    return d * 10u + (d >> 8);
+  }
+
+  inline unsigned byte_at(uint64_t w, unsigned i)
+  {
+    return static_cast<unsigned>(w >> (8u * i)) & 0xFFu;
+  }
+
+  // The fixed tail behind the day of month:
+  //
+  //   0         1         2
+  //   012345678901234567890123
+  //    Mmm YYYY HH:MM:SS +ZZZZ
+
+  std::size_t const tail_length = 24u;
+
+  word_layout const year_hour  ("DDDD DD:");   // offset  5
+  word_layout const min_sec    ("DD:DD ??");   // offset 13
+  word_layout const sec_zone   ("DD ?DDDD");   // offset 16, sign checked separately
+}
+
+std::size_t rfc2822::fixed_date_parser::scan(timestamp & ts, char const * first, char const * last)
+{
+  char const * p( first );
+  int wday( 0 );
+
+  if (last - p >= 5 && !is_digit(*p))
+  {
+    if ((wday = lookup3(&rfc2822::wday_parser::find, p)) < 0 || p[3] != ',' || p[4] != ' ')
+      return 0u;
+    p += 5;
+  }
+
+  if (last - p < 1 || !is_digit(*p))
+    return 0u;
+  int mday( *p++ - '0' );
+  if (p != last && is_digit(*p))
+    mday = mday * 10 + (*p++ - '0');
+
+  if (last - p < static_cast<std::ptrdiff_t>(tail_length) || p[0] != ' ' || p[4] != ' ')
+    return 0u;
+  int const mon( lookup3(&rfc2822::month_parser::find, p + 1) );
+  if (mon < 0)
+    return 0u;
+
+  uint64_t const yh( year_hour.digits(load8(p + 5)) );
+  uint64_t const ms( min_sec.digits(load8(p + 13)) );
+  uint64_t const sz( sec_zone.digits(load8(p + 16)) );
+  if (yh == ~uint64_t(0u) || ms == ~uint64_t(0u) || sz == ~uint64_t(0u))
+    return 0u;
+  char const sign( p[19] );
+  if (sign != '+' && sign != '-')
+    return 0u;
+
+  uint64_t const yh2( pairs(yh) );
+  uint64_t const ms2( pairs(ms) );
+  uint64_t const sz2( pairs(sz) );
+
+  int const year( static_cast<int>(byte_at(yh2, 0) * 100u + byte_at(yh2, 2)) );
+  if (year < 1900)
+    return 0u;                  // date_p reads these differently, if at all
+
+  int const zone( static_cast<int>((byte_at(sz2, 4) * 60u + byte_at(sz2, 6)) * 60u) );
+
+  ts.tm_wday   = wday;
+  ts.tm_mday   = mday;
+  ts.tm_mon    = mon;
+  ts.tm_year   = year - 1900;
+  ts.tm_hour   = static_cast<int>(byte_at(yh2, 5));
+  ts.tm_min    = static_cast<int>(byte_at(ms2, 0));
+  ts.tm_sec    = static_cast<int>(byte_at(sz2, 0));
+  ts.tzoffset  = sign == '+' ? zone : -zone;
+
+  return (p + tail_length) - first;
+}
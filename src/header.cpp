@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/header.hpp"
+#include <cstring>
+#include <boost/assert.hpp>
+
+using rfc2822::header_field;
+using rfc2822::header_info;
+
+namespace
+{
+  // ftext = %d33-57 / %d59-126, i.e. any printable character but ":".
+
+  inline bool is_ftext(char c)
+  {
+    unsigned char const u( static_cast<unsigned char>(c) );
+    return u > 32u && u < 127u && u != ':';
+  }
+
+  inline bool is_wsp(char c)
+  {
+    return c == ' ' || c == '\t';
+  }
+}
+
+// Line ends are found with memchr(), which the C library implements with
+// the widest vector instructions the CPU has, so the per-byte work in this
+// loop is limited to the field names and to one byte after every CRLF.
+
+header_info rfc2822::split_header( char const * first, char const * last
+                                 , std::vector<header_field> & fields
+                                 , bool at_eof
+                                 )
+{
+  char const * p( first );
+  for (;;)
+  {
+    char const * const line( p );
+    if (p == last)
+      return header_info(p, at_eof ? header_complete : header_partial);
+    if (*p == '\r' && (p + 1 == last || p[1] == '\n'))
+    {
+      if (p + 1 == last)
+        return header_info(p, at_eof ? header_malformed : header_partial);
+      return header_info(p + 2, header_complete);
+    }
+
+    while (p != last && is_ftext(*p))
+      ++p;
+    char const * const name_end( p );
+    while (p != last && is_wsp(*p))
+      ++p;
+    if (p == last)
+      return header_info(line, at_eof ? header_malformed : header_partial);
+    if (name_end == line || *p != ':')
+      return header_info(line, header_malformed);
+
+    char const * const value( ++p );
+    for (;;)
+    {
+      char const * const lf( static_cast<char const *>(std::memchr(p, '\n', last - p)) );
+      if (!lf)
+      {
+        if (!at_eof)
+          return header_info(line, header_partial);
+        fields.push_back(header_field(header_field::range_type(line, name_end), header_field::range_type(value, last)));
+        return header_info(last, header_complete);
+      }
+      p = lf + 1;
+      if (lf[-1] != '\r')
+        continue;                               // a bare LF is part of the field
+      if (p == last && !at_eof)
+        return header_info(line, header_partial);
+      if (p != last && is_wsp(*p))
+        continue;                               // a fold
+      fields.push_back(header_field(header_field::range_type(line, name_end), header_field::range_type(value, lf - 1)));
+      break;
+    }
+  }
+}
+
+rfc2822::header_stream::header_stream()
+{
+  reset();
+}
+
+void rfc2822::header_stream::reset()
+{
+  phase       = line_start;
+  start       = 0;
+  pending.clear();
+  completed.clear();
+  name_end    = 0u;
+  value_begin = 0u;
+  cr          = false;
+  crlf        = false;
+}
+
+std::size_t rfc2822::header_stream::offset(char const * p, char const * first) const
+{
+  return start ? static_cast<std::size_t>(p - start) : pending.size() + (p - first);
+}
+
+void rfc2822::header_stream::emit(char const * next_line, char const * first, std::vector<header_field> & fields)
+{
+  char const * base( start );
+  std::size_t  size( next_line - start );
+  if (!start)
+  {
+    pending.append(first, next_line);
+    completed.swap(pending);
+    pending.clear();
+    base = completed.data();
+    size = completed.size();
+  }
+  fields.push_back(header_field( header_field::range_type(base, base + name_end)
+                               , header_field::range_type(base + value_begin, base + size - 2u)
+                               ));
+}
+
+// The value is scanned just like split_header() does it, except that the
+// bytes in front of the current position may belong to an earlier chunk.
+// That's what cr and crlf remember.
+
+header_info rfc2822::header_stream::feed(char const * first, char const * last, std::vector<header_field> & fields)
+{
+  if (phase == done)
+    return header_info(first, header_complete);
+  if (phase == failed)
+    return header_info(first, header_malformed);
+
+  completed.clear();
+  start = 0;
+  char const * p( first );
+  for (;;)
+  {
+    switch (phase)
+    {
+      case line_start:
+        if (p == last)
+          return header_info(last, header_partial);
+        start = p;
+        if (*p == '\r')
+        {
+          ++p;
+          phase = blank_line;
+          continue;
+        }
+        phase = name;
+        continue;
+
+      case blank_line:
+        if (p == last)
+          return header_info(last, header_partial);
+        if (*p != '\n')
+          break;
+        phase = done;
+        return header_info(p + 1, header_complete);
+
+      case name:
+        while (p != last && is_ftext(*p))
+          ++p;
+        if (p == last)
+          break;
+        name_end = offset(p, first);
+        phase = colon;
+        continue;
+
+      case colon:
+        while (p != last && is_wsp(*p))
+          ++p;
+        if (p == last)
+          break;
+        if (name_end == 0u || *p != ':')
+        {
+          phase = failed;
+          return header_info(start ? start : first, header_malformed);
+        }
+        value_begin = offset(++p, first);
+        cr = crlf = false;
+        phase = value;
+        continue;
+
+      case value:
+        while (p != last)
+        {
+          if (crlf)
+          {
+            if (!is_wsp(*p))
+              break;
+            crlf = false;                       // a fold
+            ++p;
+            continue;
+          }
+          if (cr && *p == '\n')
+          {
+            cr   = false;
+            crlf = true;
+            ++p;
+            continue;
+          }
+          cr = false;
+          char const * const lf( static_cast<char const *>(std::memchr(p, '\n', last - p)) );
+          if (!lf)
+          {
+            cr = last[-1] == '\r';
+            p  = last;
+            break;
+          }
+          crlf = lf != p && lf[-1] == '\r';     // otherwise a bare LF
+          p    = lf + 1;
+        }
+        if (p == last)
+          break;
+        emit(p, first, fields);
+        crlf  = false;
+        start = 0;
+        phase = line_start;
+        continue;
+
+      default:
+        BOOST_ASSERT(false);
+    }
+
+    // The chunk ended within a field, or a line began with a lone CR.
+
+    if (phase == blank_line)
+    {
+      phase = failed;
+      return header_info(start ? start : first, header_malformed);
+    }
+    if (start)
+      pending.assign(start, last);
+    else
+      pending.append(first, last);
+    start = 0;
+    return header_info(last, header_partial);
+  }
+}
+
+rfc2822::header_status rfc2822::header_stream::finish(std::vector<header_field> & fields)
+{
+  switch (phase)
+  {
+    case line_start:
+    case done:
+      phase = done;
+      return header_complete;
+
+    case value:
+      completed.swap(pending);
+      pending.clear();
+      fields.push_back(header_field( header_field::range_type(completed.data(), completed.data() + name_end)
+                                   , header_field::range_type( completed.data() + value_begin
+                                                             , completed.data() + completed.size() - (crlf ? 2u : 0u)
+                                                             )
+                                   ));
+      phase = done;
+      return header_complete;
+
+    default:
+      phase = failed;
+      return header_malformed;
+  }
+}
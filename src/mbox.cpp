@@ -0,0 +1,388 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/mbox.hpp"
+#include "rfc2822/address-list.hpp"
+#include "rfc2822/skipper.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef BOOST_SPIRIT_THREADSAFE
+#  include "rfc2822/worker-pool.hpp"
+#  include <boost/bind/bind.hpp>
+#  include <boost/exception_ptr.hpp>
+#  include <boost/thread/condition_variable.hpp>
+#  include <boost/thread/mutex.hpp>
+#  include <boost/thread/thread.hpp>
+#endif
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#  define RFC2822_SSE2_KERNELS
+#endif
+
+using namespace rfc2822;
+
+namespace
+{
+  /// Does the line after the LF at p begin with "From "?
+  inline bool is_separator(char const * p, char const * last)
+  {
+    return last - p > 5 && std::memcmp(p + 1, "From ", 5) == 0;
+  }
+}
+
+char const * rfc2822::next_mbox_message(char const * first, char const * last)
+{
+  char const * p( first );
+
+#ifdef RFC2822_SSE2_KERNELS
+  // Look for an LF followed by an "F" sixteen positions at a time; that
+  // rules out nearly all line ends in one go.
+
+  __m128i const lf( _mm_set1_epi8('\n') );
+  __m128i const f( _mm_set1_epi8('F') );
+  for (; last - p > 16; p += 16)
+  {
+    unsigned mask = _mm_movemask_epi8(_mm_and_si128
+                    ( _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(p)), lf)
+                    , _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(p + 1)), f)
+                    ));
+    for (; mask; mask &= mask - 1u)
+    {
+      char const * const candidate( p + __builtin_ctz(mask) );
+      if (is_separator(candidate, last))
+        return candidate + 1;
+    }
+  }
+#endif
+
+  while ((p = static_cast<char const *>(std::memchr(p, '\n', last - p))))
+  {
+    if (is_separator(p, last))
+      return p + 1;
+    ++p;
+  }
+  return last;
+}
+
+namespace
+{
+  inline bool field_is(header_field const & f, char const * name)
+  {
+    std::size_t const len( std::strlen(name) );
+    return static_cast<std::size_t>(f.name.size()) == len && strncasecmp(f.name.begin(), name, len) == 0;
+  }
+
+  struct push_addr_spec
+  {
+    std::vector<std::string> * result;
+    explicit push_addr_spec(std::vector<std::string> & r) : result(&r) { }
+    void operator() (mailbox_view<> const & m) const { result->push_back(m.canonic_addr_spec()); }
+  };
+
+  /// Parses message headers; the buffers are kept from one message to the
+  /// next.
+  class message_parser
+  {
+  public:
+    void operator() (char const * first, char const * last, mbox_message & msg)
+    {
+      msg.has_date = false;
+      msg.from.clear();
+      msg.sender.clear();
+      msg.to.clear();
+      msg.cc.clear();
+
+      // The grammars expect CRLF line ends, which mbox files rarely have,
+      // so the header is copied with its line ends rewritten.
+
+      header.clear();
+      char const * p( static_cast<char const *>(std::memchr(first, '\n', last - first)) );
+      p = p ? p + 1 : last;
+      while (p != last)
+      {
+        char const * const lf( static_cast<char const *>(std::memchr(p, '\n', last - p)) );
+        char const * end( lf ? lf : last );
+        if (end != p && end[-1] == '\r')
+          --end;
+        if (end == p)
+          break;
+        header.append(p, end);
+        header += "\r\n";
+        p = lf ? lf + 1 : last;
+      }
+      header += "\r\n";
+
+      fields.clear();
+      split_header(header.data(), header.data() + header.size(), fields);
+      for (std::size_t i = 0; i != fields.size(); ++i)
+      {
+        header_field const & f( fields[i] );
+        if (field_is(f, "Date"))
+        {
+          if (!msg.has_date)
+            msg.has_date = parse(f.value.begin(), f.value.end(), date_p[spirit::assign_a(msg.date)] >> spirit::end_p, skipper_p).full;
+        }
+        else if (field_is(f, "From"))
+          parse_list(f, mailbox_list_p(push_addr_spec(msg.from)), msg.from);
+        else if (field_is(f, "Sender"))
+        {
+          mailbox_view<> sender;
+          if (parse(f.value.begin(), f.value.end(), mailbox_view_p[spirit::assign_a(sender)] >> spirit::end_p, skipper_p).full)
+            msg.sender = sender.canonic_addr_spec();
+        }
+        else if (field_is(f, "To"))
+          parse_list(f, address_list_p(push_addr_spec(msg.to)), msg.to);
+        else if (field_is(f, "Cc"))
+          parse_list(f, address_list_p(push_addr_spec(msg.cc)), msg.cc);
+      }
+    }
+
+  private:
+    /// Drop what a list that doesn't parse has added to \p result.
+    template <typename ParserT>
+    static void parse_list(header_field const & f, ParserT const & p, std::vector<std::string> & result)
+    {
+      std::size_t const n( result.size() );
+      if (!parse(f.value.begin(), f.value.end(), p >> spirit::end_p, skipper_p).full)
+        result.resize(n);
+    }
+
+    std::string                 header;
+    std::vector<header_field>   fields;
+  };
+
+#ifdef BOOST_SPIRIT_THREADSAFE
+
+  // Batches are claimed in order from a shared cursor. Their boundaries
+  // are found while claiming them, so the only work done under the lock is
+  // the search for the first separator after batch_size bytes. Finished
+  // batches wait in a ring buffer until the calling thread has passed all
+  // earlier ones to the handler; workers that get too far ahead wait. The
+  // workers are the library's shared threads, see task_group.
+
+  class mbox_pool
+  {
+  public:
+    mbox_pool(char const * first_, char const * last_, mbox_options const & opt, unsigned threads)
+      : first(first_), last(last_), batch_size(opt.batch_size ? opt.batch_size : 1u)
+      , cursor(first_), claimed(0u), delivered(0u), window(4u * threads), stop(false), workers(threads)
+    {
+      for (unsigned i = 0; i != threads; ++i)
+        workers.run(boost::bind(&mbox_pool::work, this));
+    }
+
+    ~mbox_pool()
+    {
+      {
+        boost::mutex::scoped_lock lock(mutex);
+        stop = true;
+      }
+      slot_free.notify_all();
+      workers.wait();
+    }
+
+    std::size_t run(mbox_handler const & handler)
+    {
+      std::size_t n( 0u );
+      std::vector<mbox_message> messages;
+      for (;;)
+      {
+        messages.clear();
+        {
+          boost::mutex::scoped_lock lock(mutex);
+          batch & b( window[delivered % window.size()] );
+          while (!b.ready && !error && !(cursor == last && delivered == claimed))
+            batch_done.wait(lock);
+          if (error)
+            boost::rethrow_exception(error);
+          if (!b.ready)
+            return n;
+          b.ready = false;
+          b.messages.swap(messages);
+          ++delivered;
+        }
+        slot_free.notify_all();
+        for (std::size_t i = 0; i != messages.size(); ++i)
+          handler(messages[i]);
+        n += messages.size();
+      }
+    }
+
+  private:
+    struct batch
+    {
+      bool                      ready;
+      std::vector<mbox_message> messages;
+      batch() : ready(false) { }
+    };
+
+    void work()
+    {
+      message_parser parse_message;
+      std::vector<mbox_message> messages;
+      try
+      {
+        for (;;)
+        {
+          char const * begin;
+          char const * end;
+          std::size_t  seq;
+          {
+            boost::mutex::scoped_lock lock(mutex);
+            while (!stop && cursor != last && claimed - delivered >= window.size())
+              slot_free.wait(lock);
+            if (stop || cursor == last)
+              return;
+            seq    = claimed++;
+            begin  = cursor;
+            end    = static_cast<std::size_t>(last - cursor) > batch_size ? next_mbox_message(cursor + batch_size - 1u, last) : last;
+            cursor = end;
+          }
+
+          for (char const * p = begin; p != end; )
+          {
+            char const * const next( next_mbox_message(p, end) );
+            messages.resize(messages.size() + 1u);
+            mbox_message & msg( messages.back() );
+            msg.offset = p - first;
+            msg.size   = next - p;
+            parse_message(p, next, msg);
+            p = next;
+          }
+
+          {
+            boost::mutex::scoped_lock lock(mutex);
+            batch & b( window[seq % window.size()] );
+            b.messages.swap(messages);
+            b.ready = true;
+          }
+          batch_done.notify_one();
+          messages.clear();
+        }
+      }
+      catch(...)
+      {
+        {
+          boost::mutex::scoped_lock lock(mutex);
+          if (!error)
+            error = boost::current_exception();
+          stop = true;
+        }
+        batch_done.notify_one();
+        slot_free.notify_all();
+      }
+    }
+
+    char const * const          first;
+    char const * const          last;
+    std::size_t const           batch_size;
+
+    boost::mutex                mutex;
+    boost::condition_variable   batch_done;
+    boost::condition_variable   slot_free;
+    char const *                cursor;
+    std::size_t                 claimed;
+    std::size_t                 delivered;
+    std::vector<batch>          window;
+    bool                        stop;
+    boost::exception_ptr        error;
+
+    rfc2822::detail::task_group workers;
+  };
+
+#endif // BOOST_SPIRIT_THREADSAFE
+}
+
+void rfc2822::parse_mbox_message(char const * first, char const * last, mbox_message & msg)
+{
+  message_parser()(first, last, msg);
+}
+
+std::size_t rfc2822::parse_mbox( char const * first, char const * last
+                               , mbox_handler const & handler
+                               , mbox_options const & opt
+                               )
+{
+#ifdef BOOST_SPIRIT_THREADSAFE
+  unsigned const threads( opt.threads ? opt.threads : boost::thread::hardware_concurrency() );
+  if (threads > 1u)
+    return mbox_pool(first, last, opt, threads).run(handler);
+#else
+  (void)opt;
+#endif
+
+  message_parser parse_message;
+  mbox_message msg;
+  std::size_t n( 0u );
+  for (char const * p = first; p != last; ++n)
+  {
+    char const * const next( next_mbox_message(p, last) );
+    msg.offset = p - first;
+    msg.size   = next - p;
+    parse_message(p, next, msg);
+    handler(msg);
+    p = next;
+  }
+  return n;
+}
+
+namespace
+{
+  void throw_system_error(char const * path)
+  {
+    throw std::runtime_error(std::string(path) + ": " + std::strerror(errno));
+  }
+}
+
+rfc2822::mapped_file::mapped_file(char const * path) : data(0), length(0u)
+{
+  int const fd( ::open(path, O_RDONLY) );
+  if (fd < 0)
+    throw_system_error(path);
+  struct stat st;
+  if (::fstat(fd, &st) != 0)
+  {
+    int const e( errno );
+    ::close(fd);
+    errno = e;
+    throw_system_error(path);
+  }
+  length = static_cast<std::size_t>(st.st_size);
+  if (length)
+  {
+    void * const p( ::mmap(0, length, PROT_READ, MAP_PRIVATE, fd, 0) );
+    if (p == MAP_FAILED)
+    {
+      int const e( errno );
+      ::close(fd);
+      errno = e;
+      throw_system_error(path);
+    }
+    ::madvise(p, length, MADV_SEQUENTIAL);
+    data = static_cast<char const *>(p);
+  }
+  ::close(fd);
+}
+
+rfc2822::mapped_file::~mapped_file()
+{
+  if (length)
+    ::munmap(const_cast<char *>(data), length);
+}
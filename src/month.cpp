@@ -13,3 +13,21 @@
 #include "rfc2822/date.hpp"
 
 rfc2822::month_parser const rfc2822::month_p;
+
+namespace rfc2822
+{
+  RFC2822_KEYWORD(month_table, 'j', 'a', 'n', 0);
+  RFC2822_KEYWORD(month_table, 'f', 'e', 'b', 1);
+  RFC2822_KEYWORD(month_table, 'm', 'a', 'r', 2);
+  RFC2822_KEYWORD(month_table, 'a', 'p', 'r', 3);
+  RFC2822_KEYWORD(month_table, 'm', 'a', 'y', 4);
+  RFC2822_KEYWORD(month_table, 'j', 'u', 'n', 5);
+  RFC2822_KEYWORD(month_table, 'j', 'u', 'l', 6);
+  RFC2822_KEYWORD(month_table, 'a', 'u', 'g', 7);
+  RFC2822_KEYWORD(month_table, 's', 'e', 'p', 8);
+  RFC2822_KEYWORD(month_table, 'o', 'c', 't', 9);
+  RFC2822_KEYWORD(month_table, 'n', 'o', 'v', 10);
+  RFC2822_KEYWORD(month_table, 'd', 'e', 'c', 11);
+
+  RFC2822_KEYWORD_TABLE(month_table, 16);
+}
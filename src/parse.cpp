@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+#include "rfc2822/parse.hpp"
+#include "rfc2822/address-ref.hpp"
+#include "rfc2822/budget.hpp"
+#include "rfc2822/date.hpp"
+#include "rfc2822/prefilter.hpp"
+#include "rfc2822/skipper.hpp"
+
+// FILTER rejects inputs that the parser cannot match before it runs.
+
+#define RFC2822_DEFINE_PARSER(NAME, PARSER, RESULT, FILTER)                             \
+  char const * rfc2822::NAME(char const * first, char const * last, RESULT & result)    \
+  {                                                                                     \
+    if (!FILTER(first, last))                                                           \
+      return 0;                                                                         \
+    spirit::parse_info<> const r                                                        \
+      = spirit::parse(first, last, PARSER [spirit::assign_a(result)], skipper_p);       \
+    return r.hit ? r.stop : 0;                                                          \
+  }
+
+RFC2822_DEFINE_PARSER(parse_addr_spec,  addr_spec_p,      std::string,    may_be_addr_spec)
+RFC2822_DEFINE_PARSER(parse_mailbox,    mailbox_p,        std::string,    any_input)
+RFC2822_DEFINE_PARSER(parse_route_addr, route_addr_p,     std::string,    any_input)
+RFC2822_DEFINE_PARSER(parse_date,       date_p,           timestamp,      any_input)
+RFC2822_DEFINE_PARSER(parse_addr_spec,  addr_spec_ref_p,  canonic_string, may_be_addr_spec)
+RFC2822_DEFINE_PARSER(parse_mailbox,    mailbox_ref_p,    canonic_string, any_input)
+
+// The bounded parsers don't filter: a filter reads all of the input, which
+// the budget is there to prevent.
+
+#define RFC2822_DEFINE_BOUNDED_PARSER(NAME, PARSER, RESULT)                                             \
+  char const * rfc2822::NAME(char const * first, char const * last, RESULT & result, parse_budget & budget) \
+  {                                                                                                     \
+    bounded_parse_info<> const r                                                                        \
+      = bounded_parse(first, last, PARSER [spirit::assign_a(result)], skipper_p, budget);               \
+    return r.hit ? r.stop : 0;                                                                          \
+  }
+
+RFC2822_DEFINE_BOUNDED_PARSER(parse_addr_spec,  addr_spec_p,      std::string)
+RFC2822_DEFINE_BOUNDED_PARSER(parse_mailbox,    mailbox_p,        std::string)
+RFC2822_DEFINE_BOUNDED_PARSER(parse_route_addr, route_addr_p,     std::string)
+RFC2822_DEFINE_BOUNDED_PARSER(parse_date,       date_p,           timestamp)
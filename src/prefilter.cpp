@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/prefilter.hpp"
+#include "rfc2822/char-class.hpp"
+
+using namespace rfc2822;
+
+// The input is classified byte by byte through char_class_table; the span
+// kernels take over only inside a run, so that a short address costs one
+// kernel call per word. Each function returns the position behind the
+// construct that starts at p, or NULL if the input ends first. They are
+// more lenient about folding than the grammar: CR and LF are stepped over
+// wherever they occur.
+
+namespace
+{
+  inline unsigned char class_of(char c)
+  {
+    return char_class_table[static_cast<unsigned char>(c)];
+  }
+
+  char const * comment_end(span_kernels const & k, char const * p, char const * last)
+  {
+    std::size_t depth( 0u );
+    for (;;)
+    {
+      p += k.ctext(p, last);
+      if (p == last)
+        return 0;
+      switch (*p++)
+      {
+        case '(':
+          ++depth;
+          break;
+        case ')':
+          if (--depth == 0u)
+            return p;
+          break;
+        case '\\':
+          if (p++ == last)
+            return 0;
+          break;
+      }
+    }
+  }
+
+  char const * quoted_string_end(span_kernels const & k, char const * p, char const * last)
+  {
+    for (++p;;)
+    {
+      p += k.qtext(p, last);
+      if (p == last)
+        return 0;
+      switch (*p++)
+      {
+        case '"':
+          return p;
+        case '\\':
+          if (p++ == last)
+            return 0;
+          break;
+      }
+    }
+  }
+
+  /// Skip white space, line breaks, and comments.
+  char const * cfws_end(span_kernels const & k, char const * p, char const * last)
+  {
+    while (p != last)
+    {
+      if (class_of(*p) & wsp_class || *p == '\r' || *p == '\n')
+        ++p;
+      else if (*p == '(')
+      {
+        if (!(p = comment_end(k, p, last)))
+          return 0;
+      }
+      else
+        break;
+    }
+    return p;
+  }
+}
+
+bool rfc2822::may_be_addr_spec(char const * first, char const * last)
+{
+  span_kernels const & k( best_span_kernels() );
+  char const * p( first );
+  bool word( false );
+  for (;;)
+  {
+    p = cfws_end(k, p, last);
+    if (!p || p == last)
+      return false;
+    if (class_of(*p) & atext_class)
+    {
+      p += k.atext(p, last);
+      word = true;
+    }
+    else if (*p == '.')
+      ++p;
+    else if (*p == '"')
+    {
+      if (!(p = quoted_string_end(k, p, last)))
+        return false;
+      word = true;
+    }
+    else if (*p == '@')
+      break;
+    else
+      return false;
+  }
+  if (!word)
+    return false;
+  p = cfws_end(k, p + 1, last);
+  return p && p != last && (*p == '[' || class_of(*p) & atext_class);
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/address-list.hpp"
+#include "rfc2822/address-ref.hpp"
+#include "rfc2822/budget.hpp"
+#include "rfc2822/char-class.hpp"
+#include "rfc2822/comment.hpp"
+#include "rfc2822/crlf.hpp"
+#include "rfc2822/date.hpp"
+#include "rfc2822/lwsp.hpp"
+#include "rfc2822/quoted-pair.hpp"
+#include "rfc2822/quoted-string.hpp"
+#include "rfc2822/recognize.hpp"
+#include "rfc2822/skipper.hpp"
+#include <cstring>
+
+using namespace rfc2822;
+
+namespace
+{
+  // Between them, the samples take every grammar through every rule that
+  // switches to a scanner of its own, like lexeme_d and no_actions_d do.
+  // Without skipper_p, the parsers stop at the first white space, hence the
+  // compact variants.
+
+  char const * const samples[] =
+    { "simple@example.org"
+    , "peter\r\n . \r\n simons @ (Peter (nested)) cryp.to"
+    , "\"quoted \\\" string\" @ [127\r\n  .0\r\n\t.0.1]"
+    , "\"quoted\".local@[127.0.0.1]"
+    , "Name<@route.org,@[1.2.3.4]:\"q\".local@example.org>"
+    , "Name <simple@example.org>"
+    , "Group:a@b,\"c\"<@d:e@[1.2.3.4]>;"
+    , " Peter Simons < normal . address @ example\r\n\t.org >"
+    , "Dies \"ist \\\" > ein\" Test <@yahoo.org,@hugelwurz.cys.de:\"normal . address \"@ example\r\n\t.org >"
+    , "a@b, \"Doe, John\" <j.doe@example.org>, Friends: x@y, (a, b) Z <z@w>;, undisclosed-recipients:;"
+    , "Thu, 04 Sep 1973 14:12:17 +0100"
+    , "thu, 4 sep 73 14:12 EST (Eastern)"
+    , "1 Jan 2000 00:00:00 Z"
+    , "\r\n\t(comment)\r\n"
+    };
+
+  struct ignore_mailbox
+  {
+    void operator() (mailbox_view<> const &) const { }
+  };
+
+  template <typename ParserT>
+  void prepare(ParserT const & p)
+  {
+    for (std::size_t i = 0; i != sizeof(samples) / sizeof(samples[0]); ++i)
+    {
+      char const * const first = samples[i];
+      char const * const last  = first + std::strlen(first);
+      parse(first, last, p, skipper_p);
+      parse(first, last, p);
+      parse(first, last, spirit::no_actions_d[p], skipper_p);
+      parse(first, last, spirit::no_actions_d[p]);
+      parse_budget budget;
+      bounded_parse(first, last, p, skipper_p, budget);
+      bounded_parse(first, last, p, budget);
+    }
+  }
+}
+
+void rfc2822::prepare_parsers()
+{
+  best_span_kernels();
+
+  prepare(date_p);
+  prepare(fixed_date_p);
+  prepare(mailbox_p);
+  prepare(addr_spec_p);
+  prepare(simple_addr_spec_p);
+  prepare(mailbox_view_p);
+  prepare(addr_spec_view_p);
+  prepare(mailbox_ref_p);
+  prepare(addr_spec_ref_p);
+  prepare(mailbox_list_p(ignore_mailbox()));
+  prepare(address_list_p(ignore_mailbox()));
+  prepare(route_addr_p);
+  prepare(local_part_p);
+  prepare(domain_literal_p);
+  prepare(domain_p);
+  prepare(comment_p);
+  prepare(crlf_p);
+  prepare(month_p);
+  prepare(wday_p);
+  prepare(timezone_p);
+  prepare(lwsp_p);
+  prepare(skipper_p);
+  prepare(word_p);
+  prepare(atom_p);
+  prepare(quoted_string_p);
+  prepare(quoted_pair_p);
+
+  for (std::size_t i = 0; i != sizeof(samples) / sizeof(samples[0]); ++i)
+  {
+    char const * const first = samples[i];
+    char const * const last  = first + std::strlen(first);
+    std::vector<std::string> mailboxes;
+    recognize_addr_spec(first, last);
+    recognize_mailbox(first, last);
+    recognize_route_addr(first, last);
+    recognize_date(first, last);
+    parse_address_list(first, last, mailboxes);
+  }
+}
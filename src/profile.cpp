@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/profile.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <list>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using rfc2822::rule_profile;
+
+namespace
+{
+  // The profiles themselves, one per grammar and rule name, and an open
+  // addressing table that maps the address of every named rule to its
+  // profile. Rules are named once per grammar definition, so the table
+  // only has to hold a few hundred of them.
+
+  struct named_profile
+  {
+    std::string         grammar;
+    std::string         name;
+    rule_profile        profile;
+  };
+
+  std::list<named_profile> profiles;
+
+  enum { table_size = 4096 };
+
+  struct slot
+  {
+    void const *        rule;
+    rule_profile *      profile;
+  };
+
+  slot table[table_size];
+
+  std::size_t hash(void const * rule)
+  {
+    return (reinterpret_cast<std::size_t>(rule) >> 3) * 2654435761u;
+  }
+
+  std::string grammar_of(char const * file)
+  {
+    char const * base( std::strrchr(file, '/') );
+    base = base ? base + 1 : file;
+    char const * const dot( std::strrchr(base, '.') );
+    return std::string(base, dot ? dot : base + std::strlen(base));
+  }
+
+  rule_profile & profile_of(std::string const & grammar, char const * name)
+  {
+    for (std::list<named_profile>::iterator i = profiles.begin(); i != profiles.end(); ++i)
+      if (i->grammar == grammar && i->name == name)
+        return i->profile;
+    profiles.push_back(named_profile());
+    named_profile & p( profiles.back() );
+    p.grammar = grammar;
+    p.name    = name;
+    rule_profile const zero = { p.grammar.c_str(), p.name.c_str(), 0u, 0u, 0u, 0u, 0u };
+    p.profile = zero;
+    return p.profile;
+  }
+
+  bool more_calls(rule_profile const * a, rule_profile const * b)
+  {
+    return a->calls > b->calls;
+  }
+}
+
+rule_profile * rfc2822::find_rule_profile(void const * rule)
+{
+  for (std::size_t i = hash(rule), n = 0; n != table_size; ++i, ++n)
+  {
+    slot const & s( table[i % table_size] );
+    if (s.rule == rule) return s.profile;
+    if (!s.rule)        break;
+  }
+  return 0;
+}
+
+void rfc2822::register_rule_profile(void const * rule, char const * file, char const * name)
+{
+  // A definition may occupy the memory of an earlier one, so a known
+  // address is simply renamed. When the table is full, further rules go
+  // uncounted.
+  rule_profile & p( profile_of(grammar_of(file), name) );
+  for (std::size_t i = hash(rule), n = 0; n != table_size; ++i, ++n)
+  {
+    slot & s( table[i % table_size] );
+    if (!s.rule || s.rule == rule)
+    {
+      s.rule    = rule;
+      s.profile = &p;
+      return;
+    }
+  }
+}
+
+void rfc2822::dump_rule_profiles(std::ostream & os)
+{
+  std::vector<rule_profile const *> sorted;
+  for (std::list<named_profile>::const_iterator i = profiles.begin(); i != profiles.end(); ++i)
+    sorted.push_back(&i->profile);
+  std::stable_sort(sorted.begin(), sorted.end(), more_calls);
+
+  char line[256];
+  std::sprintf(line, "%-32s %12s %12s %12s %14s %10s %14s\n", "rule", "calls", "hits", "misses", "bytes", "bytes/hit", "cycles/call");
+  os << line;
+  for (std::size_t i = 0; i != sorted.size(); ++i)
+  {
+    rule_profile const & p( *sorted[i] );
+    std::string const name( p.grammar + std::string(":") + p.name );
+    std::sprintf( line, "%-32s %12llu %12llu %12llu %14llu %10.1f %14.1f\n", name.c_str()
+                , static_cast<unsigned long long>(p.calls)
+                , static_cast<unsigned long long>(p.hits)
+                , static_cast<unsigned long long>(p.misses)
+                , static_cast<unsigned long long>(p.bytes)
+                , p.hits ? double(p.bytes) / double(p.hits) : 0.0
+                , p.calls ? double(p.cycles) / double(p.calls) : 0.0
+                );
+    os << line;
+  }
+}
+
+void rfc2822::reset_rule_profiles()
+{
+  for (std::list<named_profile>::iterator i = profiles.begin(); i != profiles.end(); ++i)
+  {
+    rule_profile & p( i->profile );
+    p.calls = p.hits = p.misses = p.bytes = p.cycles = 0u;
+  }
+}
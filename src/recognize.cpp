@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/recognize.hpp"
+#include "rfc2822/address.hpp"
+#include "rfc2822/date.hpp"
+#include "rfc2822/prefilter.hpp"
+
+// FILTER rejects inputs that the parser cannot match before it runs.
+
+#define RFC2822_DEFINE_RECOGNIZER(NAME, PARSER, FILTER)                                 \
+  char const * rfc2822::NAME(char const * first, char const * last) throw()             \
+  {                                                                                     \
+    if (!FILTER(first, last))                                                           \
+      return 0;                                                                         \
+    try                                                                                 \
+    {                                                                                   \
+      return recognize(PARSER, first, last);                                            \
+    }                                                                                   \
+    catch(...)                                                                          \
+    {                                                                                   \
+      return 0;                                                                         \
+    }                                                                                   \
+  }
+
+RFC2822_DEFINE_RECOGNIZER(recognize_addr_spec,  addr_spec_p,    may_be_addr_spec)
+RFC2822_DEFINE_RECOGNIZER(recognize_mailbox,    mailbox_p,      any_input)
+RFC2822_DEFINE_RECOGNIZER(recognize_route_addr, route_addr_p,   any_input)
+RFC2822_DEFINE_RECOGNIZER(recognize_date,       date_p,         any_input)
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/simple-addr-spec.hpp"
+
+rfc2822::simple_addr_spec_parser const rfc2822::simple_addr_spec_p;
+
+// Classify every byte as atext (0), '.' (1), '@' (2), the first character
+// of a CFWS token (3), or anything else (4). The cfws class is what forces
+// a fallback after the domain: the skipper might skip over it and find
+// another ". atom" part behind it.
+
+unsigned char const rfc2822::simple_addr_spec_parser::char_class[256] =
+  {
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 3, 4, 4, 4, 3, 4, 4,   // 00-0F
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,   // 10-1F
+    3, 0, 4, 0, 0, 0, 0, 0, 3, 4, 0, 0, 4, 0, 1, 0,   // 20-2F
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4, 4, 4, 0, 4, 0,   // 30-3F
+    2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   // 40-4F
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4, 4, 4, 0, 0,   // 50-5F
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   // 60-6F
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4,   // 70-7F
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   // 80-8F
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   // 90-9F
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   // A0-AF
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   // B0-BF
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   // C0-CF
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   // D0-DF
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   // E0-EF
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0    // F0-FF
+  };
+
+#define A rfc2822::simple_addr_spec_parser::accept
+#define F rfc2822::simple_addr_spec_parser::fallback
+
+unsigned char const rfc2822::simple_addr_spec_parser::transition[accept][classes] =
+  {
+    //  atext  '.'  '@'  cfws  other
+    {   1,     F,   F,   F,    F   },       // start
+    {   1,     2,   3,   F,    F   },       // local_atom
+    {   1,     F,   F,   F,    F   },       // local_dot
+    {   4,     F,   F,   F,    F   },       // domain_start
+    {   4,     5,   A,   F,    A   },       // domain_atom
+    {   4,     F,   F,   F,    F   }        // domain_dot
+  };
+
+#undef F
+#undef A
@@ -0,0 +1,322 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/address-list.hpp"
+#include "rfc2822/skipper.hpp"
+#include <boost/spirit/include/classic_push_back_actor.hpp>
+
+#ifdef BOOST_SPIRIT_THREADSAFE
+#  include "rfc2822/worker-pool.hpp"
+#  include <boost/bind/bind.hpp>
+#  include <boost/exception_ptr.hpp>
+#  include <boost/ref.hpp>
+#  include <boost/thread/thread.hpp>
+#endif
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#  define RFC2822_SSE2_KERNELS
+#endif
+
+using namespace rfc2822;
+
+namespace
+{
+  inline bool is_special(char c)
+  {
+    switch (c)
+    {
+      case '"': case '(': case ')': case '\\': case '<': case '>':
+      case '[': case ']': case ',': case ':':  case ';':
+        return true;
+      default:
+        return false;
+    }
+  }
+
+#ifdef RFC2822_SSE2_KERNELS
+  inline __m128i eq(__m128i v, char c) { return _mm_cmpeq_epi8(v, _mm_set1_epi8(c)); }
+
+  inline unsigned special_mask(__m128i v)
+  {
+    __m128i r = _mm_or_si128(eq(v, '"'), eq(v, '\\'));
+    r = _mm_or_si128(r, _mm_or_si128(eq(v, '('), eq(v, ')')));
+    r = _mm_or_si128(r, _mm_or_si128(eq(v, '<'), eq(v, '>')));
+    r = _mm_or_si128(r, _mm_or_si128(eq(v, '['), eq(v, ']')));
+    r = _mm_or_si128(r, _mm_or_si128(eq(v, ','), eq(v, ':')));
+    r = _mm_or_si128(r, eq(v, ';'));
+    return _mm_movemask_epi8(r);
+  }
+#endif
+
+  /// Tracks the nesting of an address list, one special character at a
+  /// time.
+  class list_splitter
+  {
+  public:
+    explicit list_splitter(std::vector<char const *> & c)
+      : commas(c), escaped(0), comment_depth(0u), quoted(false), literal(false), angle(false), group(false)
+    {
+    }
+
+    bool operator() (char const * p)
+    {
+      if (p == escaped)
+        return true;
+      char const c( *p );
+      if (quoted || comment_depth || literal)
+      {
+        if (c == '\\')
+          escaped = p + 1;
+        else if (quoted)
+          quoted = c != '"';
+        else if (literal)
+        {
+          if (c == '[')
+            return false;
+          literal = c != ']';
+        }
+        else if (c == '(')
+          ++comment_depth;
+        else if (c == ')')
+          --comment_depth;
+        return true;
+      }
+      switch (c)
+      {
+        case '"':
+          quoted = true;
+          return true;
+        case '(':
+          comment_depth = 1u;
+          return true;
+        case '[':
+          literal = true;
+          return true;
+        case '<':
+          if (angle)
+            return false;
+          angle = true;
+          return true;
+        case '>':
+          if (!angle)
+            return false;
+          angle = false;
+          return true;
+        case ',':
+          if (!angle && !group)
+            commas.push_back(p);
+          return true;
+        case ':':
+          if (angle)
+            return true;                // The end of a route.
+          if (group)
+            return false;
+          group = true;
+          return true;
+        case ';':
+          if (angle || !group)
+            return false;
+          group = false;
+          return true;
+        default:                        // ')', ']', or '\\'
+          return false;
+      }
+    }
+
+    bool balanced() const
+    {
+      return !quoted && !comment_depth && !literal && !angle && !group;
+    }
+
+  private:
+    std::vector<char const *> & commas;
+    char const *                escaped;        ///< The character after a backslash.
+    unsigned                    comment_depth;
+    bool                        quoted;
+    bool                        literal;
+    bool                        angle;
+    bool                        group;
+  };
+}
+
+bool rfc2822::split_address_list(char const * first, char const * last, std::vector<char const *> & commas)
+{
+  list_splitter split(commas);
+  char const * p( first );
+
+#ifdef RFC2822_SSE2_KERNELS
+  for (; last - p >= 16; p += 16)
+  {
+    for (unsigned mask = special_mask(_mm_loadu_si128(reinterpret_cast<__m128i const *>(p))); mask; mask &= mask - 1u)
+      if (!split(p + __builtin_ctz(mask)))
+        return false;
+  }
+#endif
+
+  for (; p != last; ++p)
+    if (is_special(*p) && !split(p))
+      return false;
+  return split.balanced();
+}
+
+namespace
+{
+  /// An element of an address list. Its mailboxes, including the members
+  /// of a group, are appended to result.
+  struct element_parser : public spirit::parser<element_parser>
+  {
+    typedef element_parser self_t;
+
+    std::vector<std::string> * result;
+
+    explicit element_parser(std::vector<std::string> & r) : result(&r) { }
+
+    template <typename ScannerT>
+    typename spirit::parser_result<self_t, ScannerT>::type
+    parse(ScannerT const & scan) const
+    {
+      using namespace spirit;
+      return (  mailbox_p [push_back_a(*result)]
+             |  (word_p >> *( word_p | '.' ))
+                >> ':'
+                >> !rfc2822::detail::obs_list( mailbox_p [push_back_a(*result)] )
+                >> ';'
+             ).parse(scan);
+    }
+  };
+
+  bool parse_in_one_go(char const * first, char const * last, std::vector<std::string> & result)
+  {
+    std::size_t const n( result.size() );
+    if (parse(first, last, rfc2822::detail::obs_list(element_parser(result)) >> spirit::end_p, skipper_p).full)
+      return true;
+    result.resize(n);
+    return false;
+  }
+
+#ifdef BOOST_SPIRIT_THREADSAFE
+
+  /// The elements [begin, end) of a list that has been split at commas.
+  struct chunk
+  {
+    std::size_t                 begin;
+    std::size_t                 end;
+    std::vector<std::string>    result;
+    bool                        ok;
+    bool                        empty;          ///< All elements are empty.
+    boost::exception_ptr        error;
+
+    chunk() : begin(0u), end(0u), ok(false), empty(true) { }
+  };
+
+  void parse_chunk(char const * first, char const * last, std::vector<char const *> const & commas, chunk & c)
+  {
+    try
+    {
+      element_parser const element(c.result);
+      for (std::size_t i = c.begin; i != c.end; ++i)
+      {
+        char const * const b( i ? commas[i - 1u] + 1 : first );
+        char const * const e( i < commas.size() ? commas[i] : last );
+        if (parse(b, e, spirit::end_p, skipper_p).full)
+          continue;
+        c.empty = false;
+        if (!parse(b, e, element >> spirit::end_p, skipper_p).full)
+          return;
+      }
+      c.ok = true;
+    }
+    catch(...)
+    {
+      c.error = boost::current_exception();
+    }
+  }
+
+  // The elements are cut into one chunk of about the same size per thread.
+  // The calling thread parses the first chunk itself and the library's
+  // worker threads take the others; the results are merged once all chunks
+  // are done.
+
+  bool parse_in_chunks( char const * first, char const * last
+                      , std::vector<char const *> const & commas
+                      , unsigned threads
+                      , std::vector<std::string> & result
+                      )
+  {
+    std::size_t const elements( commas.size() + 1u );
+    std::size_t const target( (last - first) / threads );
+    std::vector<chunk> chunks(1u);
+    char const * start( first );
+    for (std::size_t i = 0; i != commas.size() && chunks.size() != threads; ++i)
+    {
+      if (static_cast<std::size_t>(commas[i] - start) >= target)
+      {
+        chunks.back().end = i + 1u;
+        chunks.push_back(chunk());
+        chunks.back().begin = i + 1u;
+        start = commas[i] + 1;
+      }
+    }
+    chunks.back().end = elements;
+
+    {
+      rfc2822::detail::task_group workers( static_cast<unsigned>(chunks.size() - 1u) );
+      for (std::size_t i = 1; i != chunks.size(); ++i)
+        workers.run(boost::bind(&parse_chunk, first, last, boost::cref(commas), boost::ref(chunks[i])));
+      parse_chunk(first, last, commas, chunks[0]);
+      workers.wait();
+    }
+
+    bool empty( true );
+    std::size_t size( 0u );
+    for (std::size_t i = 0; i != chunks.size(); ++i)
+    {
+      if (chunks[i].error)
+        boost::rethrow_exception(chunks[i].error);
+      if (!chunks[i].ok)
+        return false;
+      empty = empty && chunks[i].empty;
+      size += chunks[i].result.size();
+    }
+    if (empty)
+      return false;
+
+    std::size_t n( result.size() );
+    result.resize(n + size);
+    for (std::size_t i = 0; i != chunks.size(); ++i)
+      for (std::size_t j = 0; j != chunks[i].result.size(); ++j)
+        result[n++].swap(chunks[i].result[j]);
+    return true;
+  }
+
+#endif // BOOST_SPIRIT_THREADSAFE
+}
+
+bool rfc2822::parse_address_list( char const * first, char const * last
+                                , std::vector<std::string> & result
+                                , address_list_options const & opt
+                                )
+{
+#ifdef BOOST_SPIRIT_THREADSAFE
+  std::size_t const chunks( static_cast<std::size_t>(last - first) / (opt.min_chunk ? opt.min_chunk : 1u) );
+  unsigned threads( opt.threads ? opt.threads : boost::thread::hardware_concurrency() );
+  if (threads > chunks)
+    threads = static_cast<unsigned>(chunks);
+  std::vector<char const *> commas;
+  if (threads > 1u && split_address_list(first, last, commas) && parse_in_chunks(first, last, commas, threads, result))
+    return true;
+#else
+  (void)opt;
+#endif
+  return parse_in_one_go(first, last, result);
+}
@@ -13,3 +13,46 @@
 #include "rfc2822/date.hpp"
 
 rfc2822::timezone_parser const rfc2822::timezone_p;
+
+namespace rfc2822
+{
+  RFC2822_KEYWORD(timezone_table, 'u', 't', 0, 0);
+  RFC2822_KEYWORD(timezone_table, 'g', 'm', 't', 0);
+  RFC2822_KEYWORD(timezone_table, 'e', 's', 't', -18000);
+  RFC2822_KEYWORD(timezone_table, 'e', 'd', 't', -14400);
+  RFC2822_KEYWORD(timezone_table, 'c', 's', 't', -21600);
+  RFC2822_KEYWORD(timezone_table, 'c', 'd', 't', -18000);
+  RFC2822_KEYWORD(timezone_table, 'm', 's', 't', -25200);
+  RFC2822_KEYWORD(timezone_table, 'm', 'd', 't', -21600);
+  RFC2822_KEYWORD(timezone_table, 'p', 's', 't', -28800);
+  RFC2822_KEYWORD(timezone_table, 'p', 'd', 't', -25200);
+
+  // Military zones as defined in RFC 822.
+  RFC2822_KEYWORD(timezone_table, 'a', 0, 0, -3600);
+  RFC2822_KEYWORD(timezone_table, 'b', 0, 0, -7200);
+  RFC2822_KEYWORD(timezone_table, 'c', 0, 0, -10800);
+  RFC2822_KEYWORD(timezone_table, 'd', 0, 0, -14400);
+  RFC2822_KEYWORD(timezone_table, 'e', 0, 0, -18000);
+  RFC2822_KEYWORD(timezone_table, 'f', 0, 0, -21600);
+  RFC2822_KEYWORD(timezone_table, 'g', 0, 0, -25200);
+  RFC2822_KEYWORD(timezone_table, 'h', 0, 0, -28800);
+  RFC2822_KEYWORD(timezone_table, 'i', 0, 0, -32400);
+  RFC2822_KEYWORD(timezone_table, 'k', 0, 0, -36000);
+  RFC2822_KEYWORD(timezone_table, 'l', 0, 0, -39600);
+  RFC2822_KEYWORD(timezone_table, 'm', 0, 0, -43200);
+  RFC2822_KEYWORD(timezone_table, 'n', 0, 0, 3600);
+  RFC2822_KEYWORD(timezone_table, 'o', 0, 0, 7200);
+  RFC2822_KEYWORD(timezone_table, 'p', 0, 0, 10800);
+  RFC2822_KEYWORD(timezone_table, 'q', 0, 0, 14400);
+  RFC2822_KEYWORD(timezone_table, 'r', 0, 0, 18000);
+  RFC2822_KEYWORD(timezone_table, 's', 0, 0, 21600);
+  RFC2822_KEYWORD(timezone_table, 't', 0, 0, 25200);
+  RFC2822_KEYWORD(timezone_table, 'u', 0, 0, 28800);
+  RFC2822_KEYWORD(timezone_table, 'v', 0, 0, 32400);
+  RFC2822_KEYWORD(timezone_table, 'w', 0, 0, 36000);
+  RFC2822_KEYWORD(timezone_table, 'x', 0, 0, 39600);
+  RFC2822_KEYWORD(timezone_table, 'y', 0, 0, 43200);
+  RFC2822_KEYWORD(timezone_table, 'z', 0, 0, 0);
+
+  RFC2822_KEYWORD_TABLE(timezone_table, 64);
+}
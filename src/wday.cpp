@@ -13,3 +13,16 @@
 #include "rfc2822/date.hpp"
 
 rfc2822::wday_parser const rfc2822::wday_p;
+
+namespace rfc2822
+{
+  RFC2822_KEYWORD(wday_table, 's', 'u', 'n', 0);
+  RFC2822_KEYWORD(wday_table, 'm', 'o', 'n', 1);
+  RFC2822_KEYWORD(wday_table, 't', 'u', 'e', 2);
+  RFC2822_KEYWORD(wday_table, 'w', 'e', 'd', 3);
+  RFC2822_KEYWORD(wday_table, 't', 'h', 'u', 4);
+  RFC2822_KEYWORD(wday_table, 'f', 'r', 'i', 5);
+  RFC2822_KEYWORD(wday_table, 's', 'a', 't', 6);
+
+  RFC2822_KEYWORD_TABLE(wday_table, 16);
+}
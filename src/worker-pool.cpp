@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/worker-pool.hpp"
+
+#ifdef BOOST_SPIRIT_THREADSAFE
+
+#include "rfc2822/base.hpp"
+#include <algorithm>
+#include <boost/bind/bind.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/once.hpp>
+#include <boost/thread/thread.hpp>
+
+// One lock guards the queue and all groups; it is only taken once per
+// task, so there is nothing to gain from finer locking. The queue holds
+// one pointer to a group for every task in that group's pending list.
+// wait() takes its group's entries out of the queue before it returns, so
+// a worker never sees a group that is gone.
+
+namespace rfc2822
+{
+  namespace detail
+  {
+    class worker_pool : private boost::noncopyable
+    {
+    public:
+      static worker_pool & instance()
+      {
+        static boost::once_flag once = BOOST_ONCE_INIT;
+        boost::call_once(&worker_pool::create, once);
+        return *the_pool;
+      }
+
+      boost::mutex mutex;
+
+      void reserve(unsigned n)
+      {
+        boost::mutex::scoped_lock lock(mutex);
+        for (; workers < n; ++workers)
+          boost::thread(boost::bind(&worker_pool::work, this)).detach();
+      }
+
+      void post(task_group * g)
+      {
+        queue.push_back(g);
+        work_ready.notify_one();
+      }
+
+      void withdraw(task_group * g)
+      {
+        queue.erase(std::remove(queue.begin(), queue.end(), g), queue.end());
+      }
+
+    private:
+      worker_pool() : workers(0u) { }
+
+      // The pool lives until the program ends; its threads may still be
+      // waiting for work when static destructors run.
+      static void create() { the_pool = new worker_pool; }
+
+      void work()
+      {
+        prepare_parsers();
+        boost::unique_lock<boost::mutex> lock(mutex);
+        for (;;)
+        {
+          while (queue.empty())
+            work_ready.wait(lock);
+          task_group & g( *queue.front() );
+          queue.pop_front();
+          task_group::task const t( g.pending.front() );
+          g.pending.pop_front();
+          ++g.running;
+          lock.unlock();
+          t();
+          lock.lock();
+          if (!--g.running && g.pending.empty())
+            g.idle.notify_all();
+        }
+      }
+
+      static worker_pool *              the_pool;
+
+      std::deque<task_group *>          queue;
+      boost::condition_variable         work_ready;
+      unsigned                          workers;
+    };
+
+    worker_pool * worker_pool::the_pool = 0;
+  }
+}
+
+using rfc2822::detail::task_group;
+using rfc2822::detail::worker_pool;
+
+task_group::task_group(unsigned workers) : running(0u)
+{
+  worker_pool::instance().reserve(workers);
+}
+
+task_group::~task_group()
+{
+  wait();
+}
+
+void task_group::run(task const & t)
+{
+  worker_pool & pool( worker_pool::instance() );
+  boost::mutex::scoped_lock lock(pool.mutex);
+  pending.push_back(t);
+  pool.post(this);
+}
+
+void task_group::wait()
+{
+  worker_pool & pool( worker_pool::instance() );
+  boost::unique_lock<boost::mutex> lock(pool.mutex);
+  pool.withdraw(this);
+  while (!pending.empty())
+  {
+    task const t( pending.front() );
+    pending.pop_front();
+    lock.unlock();
+    t();
+    lock.lock();
+  }
+  while (running)
+    idle.wait(lock);
+}
+
+#endif // BOOST_SPIRIT_THREADSAFE
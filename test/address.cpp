@@ -11,7 +11,19 @@
  */
 
 #include "rfc2822/address.hpp"
+#include "rfc2822/address-list.hpp"
+#include "rfc2822/address-ref.hpp"
+#include "rfc2822/address-view.hpp"
+#include "rfc2822/prefilter.hpp"
+#include "rfc2822/recognize.hpp"
 #include "rfc2822/skipper.hpp"
+#include <boost/spirit/include/classic_push_back_actor.hpp>
+#include <cstring>
+#include <vector>
+
+// Count allocations, so that the list parsers can be shown not to need any.
+
+#include "allocations.hpp"
 
 #define BOOST_AUTO_TEST_MAIN
 #include <boost/test/auto_unit_test.hpp>
@@ -23,6 +35,7 @@ inline char const * parse_addr_spec(string & result, char const * begin, char co
 {
   BOOST_REQUIRE(begin <= end);
   spirit::parse_info<> const r = parse(begin, end, addr_spec_p [spirit::assign_a(result)], skipper_p);
+  BOOST_REQUIRE(recognize_addr_spec(begin, end) == (r.hit ? r.stop : NULL));
   return r.hit ? r.stop : NULL;
 }
 
@@ -30,6 +43,7 @@ inline char const * parse_route_addr(string & result, char const * begin, char c
 {
   BOOST_REQUIRE(begin <= end);
   spirit::parse_info<> const r = parse(begin, end, route_addr_p [spirit::assign_a(result)], skipper_p);
+  BOOST_REQUIRE(recognize_route_addr(begin, end) == (r.hit ? r.stop : NULL));
   return r.hit ? r.stop : NULL;
 }
 
@@ -37,6 +51,32 @@ inline char const * parse_mailbox(string & result, char const * begin, char cons
 {
   BOOST_REQUIRE(begin <= end);
   spirit::parse_info<> const r = parse(begin, end, mailbox_p [spirit::assign_a(result)], skipper_p);
+  BOOST_REQUIRE(recognize_mailbox(begin, end) == (r.hit ? r.stop : NULL));
+  return r.hit ? r.stop : NULL;
+}
+
+inline char const * parse_addr_spec_reference(string & result, char const * begin, char const * end)
+{
+  BOOST_REQUIRE(begin <= end);
+  string local_part, domain;
+  spirit::parse_info<> const r = parse( begin, end
+                                      , local_part_p [spirit::assign_a(local_part)] >> '@' >> domain_p [spirit::assign_a(domain)]
+                                      , skipper_p
+                                      );
+  result = local_part + '@' + domain;
+  return r.hit ? r.stop : NULL;
+}
+
+inline char const * parse_mailbox_reference(string & result, char const * begin, char const * end)
+{
+  BOOST_REQUIRE(begin <= end);
+  string route_addr, addr_spec;
+  spirit::parse_info<> const r = parse( begin, end
+                                      , !(word_p >> *(word_p | '.')) >> route_addr_p [spirit::assign_a(route_addr)]
+                                      | addr_spec_p [spirit::assign_a(addr_spec)]
+                                      , skipper_p
+                                      );
+  result = route_addr.empty() ? addr_spec : route_addr;
   return r.hit ? r.stop : NULL;
 }
 
@@ -55,6 +95,14 @@ inline char const * parse_mailbox(string & result, char const * cstr)
   return parse_mailbox(result, cstr, cstr + strlen(cstr));
 }
 
+inline size_t mailbox_allocations(char const * cstr)
+{
+  string result;
+  size_t const before( allocations );
+  BOOST_REQUIRE(parse(cstr, mailbox_p [spirit::assign_a(result)], skipper_p).full);
+  return allocations - before;
+}
+
 BOOST_AUTO_TEST_CASE( test_rfc2822_address_parser )
 {
   string result;
@@ -77,6 +125,13 @@ BOOST_AUTO_TEST_CASE( test_rfc2822_address_parser )
   rc = parse_addr_spec(result, "peter\r\n . \r\n simons @ [127\r\n  .0\r\n.0.1]");
   BOOST_REQUIRE(!rc);
 
+  char const * const dotted = "peter . simons @ cryp.to.\"b\"@c";
+  BOOST_REQUIRE_EQUAL(parse_addr_spec(result, dotted), dotted + 24);
+  BOOST_REQUIRE_EQUAL(result, "peter.simons@cryp.to");
+
+  BOOST_REQUIRE(parse("peter.(x)", local_part_p [spirit::assign_a(result)], skipper_p).hit);
+  BOOST_REQUIRE_EQUAL(result, "peter");
+
   // route-addr
 
   rc = parse_route_addr(result, "< normal . address @ example\r\n\t.org >");
@@ -117,3 +172,491 @@ BOOST_AUTO_TEST_CASE( test_rfc2822_address_parser )
   rc = parse_mailbox(result, "< @yahoo.org,,: normal . address @ example\r\n\t.org >");
   BOOST_REQUIRE(!rc);
 }
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_addr_spec_fast_path )
+{
+  // addr_spec_p tries simple_addr_spec_p first; make sure that it behaves
+  // exactly like the full grammar no matter whether the fast path applies.
+
+  char const * const inputs[] =
+    { "simons@cryp.to", "peter.simons@cryp.to", "a@b", "a@b.c.d.e", "  a@b", "\r\n a@b"
+    , "a@b>", "a@b,c@d", "a@b;", "a@b@c", "a@b\"x\"", "a@b]", "a@b[", "a@b\x01", "a@b\nfoo", "a@b)"
+    , "a@b ", "a@b (comment)", "a@b (comment) .c", "a@b\r\n .c", "a@b\r\nc", "a@b\r", "a@b\t.c"
+    , "a@b.", "a@b..c", "a@b.[1.2.3.4]", "a@[1.2.3.4]", "a@b.(x)c"
+    , "a.@b", ".a@b", "a..b@c", "\"a b\"@c", "a.\"b\"@c", "a @b", "a(x)@b", "a\r\n @b", "@b", "a@", "a", ""
+    , "\xe4\xf6\xfc@example.org", "a\x7f@b", "a@b\x7f", "a!#$%&'*+/=?^_`{|}~@b", "a\\b@c"
+    };
+
+  for (size_t i = 0; i != sizeof(inputs) / sizeof(inputs[0]); ++i)
+  {
+    char const * const begin = inputs[i];
+    char const * const end   = begin + strlen(begin);
+    string expected, result;
+    char const * const expected_stop = parse_addr_spec_reference(expected, begin, end);
+    char const * const stop          = parse_addr_spec(result, begin, end);
+    BOOST_REQUIRE_MESSAGE(stop == expected_stop, "stop position differs for input #" << i);
+    if (stop) BOOST_REQUIRE_EQUAL(result, expected);
+  }
+
+  spirit::parse_info<> const r = parse("peter.simons@cryp.to", simple_addr_spec_p);
+  BOOST_REQUIRE(r.full);
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_mailbox_view )
+{
+  typedef mailbox_view<>::range_type range_type;
+  mailbox_view<> v;
+  char const * input;
+  spirit::parse_info<> r;
+
+  input = "peter.simons@cryp.to";
+  r = parse(input, addr_spec_view_p [spirit::assign_a(v)], skipper_p);
+  BOOST_REQUIRE(r.full);
+  BOOST_REQUIRE_EQUAL(v.local_part, range_type(input, input + 12));
+  BOOST_REQUIRE_EQUAL(v.domain, range_type(input + 13, input + 20));
+  BOOST_REQUIRE(v.display_name.empty());
+  BOOST_REQUIRE_EQUAL(v.route_size, 0u);
+
+  input = " Dr. Foo (Bar) <@yahoo.org,@hugelwurz.cys.de: foo . bar @ example\r\n\t.org >";
+  r = parse(input, mailbox_view_p [spirit::assign_a(v)], skipper_p);
+  BOOST_REQUIRE(r.full);
+  BOOST_REQUIRE_EQUAL(v.display_name, range_type(input + 1, input + 8));
+  BOOST_REQUIRE_EQUAL(v.route, range_type(input + 16, input + 45));
+  BOOST_REQUIRE_EQUAL(v.route_size, 2u);
+  BOOST_REQUIRE_EQUAL(v.route_hops[0], range_type(input + 17, input + 26));
+  BOOST_REQUIRE_EQUAL(v.canonic_route_hop(1), "hugelwurz.cys.de");
+  BOOST_REQUIRE_EQUAL(v.local_part, range_type(input + 46, input + 55));
+  BOOST_REQUIRE_EQUAL(v.canonic_local_part(), "foo.bar");
+  BOOST_REQUIRE_EQUAL(v.canonic_domain(), "example.org");
+
+  // The views must agree with the string-building parsers on everything
+  // they accept.
+
+  char const * const inputs[] =
+    { "peter\r\n . \r\n simons @ (Peter) cryp.to"
+    , "peter\r\n . \r\n simons @ [127\r\n  .0\r\n\t.0.1]"
+    , "normal .  @ example\r\n\t.org"
+    , "< normal . address @ example\r\n\t.org >"
+    , " Peter Simons < normal . address @ example\r\n\t.org >"
+    , "normal . address @ example\r\n\t.org (Peter Simnos)"
+    , "Dies \"ist \\\" > ein\" Test <@yahoo.org,@hugelwurz.cys.de:\"normal . address \"@ example\r\n\t.org >"
+    , " Peter < simons < @yahoo.org normal . address @ example\r\n\t.org >"
+    , "< @yahoo.org,,: normal . address @ example\r\n\t.org >"
+    , "a@b", "a.b <c@d>", "<a@b", "a@b>"
+    };
+
+  for (size_t i = 0; i != sizeof(inputs) / sizeof(inputs[0]); ++i)
+  {
+    char const * const begin = inputs[i];
+    char const * const end   = begin + strlen(begin);
+    string expected;
+
+    char const * const addr_spec_stop = parse_addr_spec(expected, begin, end);
+    r = parse(begin, end, addr_spec_view_p [spirit::assign_a(v)], skipper_p);
+    BOOST_REQUIRE_MESSAGE((r.hit ? r.stop : NULL) == addr_spec_stop, "addr_spec stop position differs for input #" << i);
+    if (r.hit) BOOST_REQUIRE_EQUAL(v.canonic_addr_spec(), expected);
+
+    char const * const mailbox_stop = parse_mailbox(expected, begin, end);
+    r = parse(begin, end, mailbox_view_p [spirit::assign_a(v)], skipper_p);
+    BOOST_REQUIRE_MESSAGE((r.hit ? r.stop : NULL) == mailbox_stop, "mailbox stop position differs for input #" << i);
+    if (r.hit)
+    {
+      string canonic( v.canonic_addr_spec() );
+      if (v.route_size)
+      {
+        string route;
+        for (size_t n = 0; n != v.route_size; ++n)
+          route += (n ? ",@" : "@") + v.canonic_route_hop(n);
+        canonic = route + ':' + canonic;
+      }
+      if (expected[0] == '<') canonic = '<' + canonic + '>';
+      BOOST_REQUIRE_EQUAL(canonic, expected);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_mailbox_single_pass )
+{
+  // mailbox_p decides between name-addr and addr-spec in one pass; make
+  // sure it accepts exactly what the straightforward grammar accepts.
+
+  char const * const inputs[] =
+    { "simons@cryp.to", "user@example.org (Name)", "Peter Simons <simons@cryp.to>", "<simons@cryp.to>"
+    , "\"Peter Simons\" <simons@cryp.to>", "Peter . Simons <simons@cryp.to>", "Dr. Foo <a@b>", "a.b.c <a@b>"
+    , ". <a@b>", "a@b <c@d>", "a <@x,@y:b@c>", "a b@c", "a.b@c", "\"a b\"@c (d)", "a (b) . c @ d"
+    , "a (b) c <d@e>", "a <b", "a <b@c", "a@", "a@b.", "<a@b", "@a", "a", ""
+    , "Dies \"ist \\\" > ein\" Test <@yahoo.org,@hugelwurz.cys.de:\"normal . address \"@ example\r\n\t.org >"
+    };
+
+  for (size_t i = 0; i != sizeof(inputs) / sizeof(inputs[0]); ++i)
+  {
+    string const input( inputs[i] );
+    for (size_t len = 0; len <= input.size(); ++len)
+    {
+      char const * const begin = input.data();
+      char const * const end   = begin + len;
+      string expected, result;
+      char const * const expected_stop = parse_mailbox_reference(expected, begin, end);
+      char const * const stop          = parse_mailbox(result, begin, end);
+      BOOST_REQUIRE_MESSAGE(stop == expected_stop, "stop position differs for: " << string(begin, end));
+      if (stop) BOOST_REQUIRE_EQUAL(result, expected);
+    }
+  }
+
+  // The first word of a display name is never built into a local part,
+  // so the name costs no allocations.
+
+  char const * const addr  = "<peter.simons@example.org>";
+  char const * const named = "Peter-Simons-has-a-long-name <peter.simons@example.org>";
+  mailbox_allocations(addr);
+  mailbox_allocations(named);
+  BOOST_REQUIRE_EQUAL(mailbox_allocations(named), mailbox_allocations(addr));
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_canonic_string )
+{
+  // addr_spec_ref_p and mailbox_ref_p must produce what addr_spec_p and
+  // mailbox_p produce, whether they refer to the input or not.
+
+  char const * const inputs[] =
+    { "simons@cryp.to", "  peter.simons@cryp.to", "a@b (comment)", "a@b\r\n .c", "\"a b\"@c", "a @b"
+    , "Peter Simons <simons@cryp.to>", "<simons@cryp.to>", "\"Peter Simons\" <a.b@c.d>", "Dr. Foo <a@b>"
+    , "< a@b>", "<a@b >", "<a@b (x)>", "<@x,@y:b@c>", "a <b@c", "a b@c", "<a@b", "a.b <c@d>e"
+    , "Dies \"ist \\\" > ein\" Test <@yahoo.org,@hugelwurz.cys.de:\"normal . address \"@ example\r\n\t.org >"
+    };
+
+  for (size_t i = 0; i != sizeof(inputs) / sizeof(inputs[0]); ++i)
+  {
+    string const input( inputs[i] );
+    for (size_t len = 0; len <= input.size(); ++len)
+    {
+      char const * const begin = input.data();
+      char const * const end   = begin + len;
+      string expected;
+      canonic_string result;
+      spirit::parse_info<> r;
+
+      char const * const addr_spec_stop = parse_addr_spec(expected, begin, end);
+      r = parse(begin, end, addr_spec_ref_p [spirit::assign_a(result)], skipper_p);
+      BOOST_REQUIRE_MESSAGE((r.hit ? r.stop : NULL) == addr_spec_stop, "addr_spec stop position differs for: " << string(begin, end));
+      if (r.hit) BOOST_REQUIRE_EQUAL(result, expected);
+      if (r.hit && result.is_slice()) BOOST_REQUIRE(begin <= result.begin() && result.end() <= end);
+
+      char const * const mailbox_stop = parse_mailbox(expected, begin, end);
+      r = parse(begin, end, mailbox_ref_p [spirit::assign_a(result)], skipper_p);
+      BOOST_REQUIRE_MESSAGE((r.hit ? r.stop : NULL) == mailbox_stop, "mailbox stop position differs for: " << string(begin, end));
+      if (r.hit) BOOST_REQUIRE_EQUAL(result, expected);
+      if (r.hit && result.is_slice()) BOOST_REQUIRE(begin <= result.begin() && result.end() <= end);
+    }
+  }
+
+  // Canonic input is referred to, not copied.
+
+  char const * const canonic[] =
+    { "simons@cryp.to", "  peter.simons@cryp.to", "Peter Simons <simons@cryp.to>", "<a@b>"
+    , "\"Peter \\\"S.\\\"\" (x) <a.b@c.d>", " (x) <a.b@c.d>"
+    };
+  for (size_t i = 0; i != sizeof(canonic) / sizeof(canonic[0]); ++i)
+  {
+    char const * const begin = canonic[i];
+    char const * const end   = begin + strlen(begin);
+    canonic_string result;
+    BOOST_REQUIRE(parse(begin, end, mailbox_ref_p [spirit::assign_a(result)], skipper_p).full);
+    BOOST_REQUIRE(result.is_slice());
+    size_t const before( allocations );
+    bool const full( parse(begin, end, mailbox_ref_p [spirit::assign_a(result)], skipper_p).full );
+    size_t const allocated( allocations - before );
+    BOOST_REQUIRE(full);
+    BOOST_REQUIRE_EQUAL(allocated, 0u);
+  }
+
+  canonic_string result;
+  BOOST_REQUIRE(parse("< a@b>", mailbox_ref_p [spirit::assign_a(result)], skipper_p).full);
+  BOOST_REQUIRE(!result.is_slice());
+  BOOST_REQUIRE_EQUAL(result.str(), "<a@b>");
+  BOOST_REQUIRE(parse("Peter Simons < simons@cryp.to>", mailbox_ref_p [spirit::assign_a(result)], skipper_p).full);
+  BOOST_REQUIRE(!result.is_slice());
+  BOOST_REQUIRE_EQUAL(result.str(), "<simons@cryp.to>");
+  BOOST_REQUIRE(parse("a@b (comment)", addr_spec_ref_p [spirit::assign_a(result)], skipper_p).hit);
+  BOOST_REQUIRE(!result.is_slice());
+  BOOST_REQUIRE_EQUAL(result.str(), "a@b");
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_arena_string )
+{
+  // Parsers instantiated for arena_string produce what the std::string
+  // ones produce, and take all their memory from the arena in scope.
+
+  basic_addr_spec_parser<arena_string> const addr_spec_arena_p;
+  basic_mailbox_parser<arena_string> const   mailbox_arena_p;
+
+  char const * const inputs[] =
+    { "simons@cryp.to", "peter\r\n . \r\n simons @ (Peter) cryp.to", "\"a b\"@[1.2\r\n .3.4]"
+    , "Peter Simons <simons@cryp.to>", "a.b <c@d>e", "<@x,@y:b@c>"
+    , "Dies \"ist \\\" > ein\" Test <@yahoo.org,@hugelwurz.cys.de:\"normal . address \"@ example\r\n\t.org >"
+    };
+
+  for (size_t i = 0; i != sizeof(inputs) / sizeof(inputs[0]); ++i)
+  {
+    char const * const begin = inputs[i];
+    char const * const end   = begin + strlen(begin);
+    string expected;
+    spirit::parse_info<> r;
+
+    char buffer[4096];
+    arena pool(buffer, sizeof(buffer));
+    arena::scope const scope(pool);
+    arena_string result;
+
+    char const * const addr_spec_stop = parse_addr_spec(expected, begin, end);
+    r = parse(begin, end, addr_spec_arena_p [spirit::assign_a(result)], skipper_p);
+    BOOST_REQUIRE((r.hit ? r.stop : NULL) == addr_spec_stop);
+    if (r.hit) BOOST_REQUIRE_EQUAL(string(result.begin(), result.end()), expected);
+
+    char const * const mailbox_stop = parse_mailbox(expected, begin, end);
+    r = parse(begin, end, mailbox_arena_p [spirit::assign_a(result)], skipper_p);
+    BOOST_REQUIRE((r.hit ? r.stop : NULL) == mailbox_stop);
+    BOOST_REQUIRE(r.hit);
+    BOOST_REQUIRE_EQUAL(string(result.begin(), result.end()), expected);
+
+    size_t const before( allocations );
+    r = parse(begin, end, mailbox_arena_p [spirit::assign_a(result)], skipper_p);
+    size_t const allocated( allocations - before );
+    BOOST_REQUIRE(r.stop == mailbox_stop);
+    BOOST_REQUIRE_EQUAL(allocated, 0u);
+  }
+
+  // Without a buffer, memory comes in blocks; release() frees them all.
+
+  arena pool(64u);
+  void * const p = pool.allocate(1u);
+  BOOST_REQUIRE(pool.allocate(1u) == static_cast<char *>(p) + arena::alignment);
+  BOOST_REQUIRE(arena::current() == NULL);
+  {
+    arena::scope const scope(pool);
+    BOOST_REQUIRE(arena::current() == &pool);
+    arena inner;
+    {
+      arena::scope const scope(inner);
+      BOOST_REQUIRE(arena::current() == &inner);
+    }
+    BOOST_REQUIRE(arena::current() == &pool);
+    size_t const before( allocations );
+    arena_string s("a string that doesn't fit into one block of 64 bytes, so it needs a second one");
+    BOOST_REQUIRE_EQUAL(allocations - before, 1u);
+  }
+  BOOST_REQUIRE(arena::current() == NULL);
+  pool.release();
+}
+
+inline bool may_be_addr_spec(char const * cstr)
+{
+  return rfc2822::may_be_addr_spec(cstr, cstr + strlen(cstr));
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_prefilter )
+{
+  char const * const accepted[] =
+    { "peter\r\n . \r\n simons @ (Peter) cryp.to"
+    , "peter\r\n . \r\n simons @ [127\r\n  .0\r\n\t.0.1]"
+    , "\"a@b \\\" (c\"(x (y) \\)) . d @ e"
+    , "\xe4\xf6\xfc@example.org"
+    , "a@b>"
+    , "normal .  @ example.org"        // The grammar rejects this one.
+    };
+  for (size_t i = 0; i != sizeof(accepted) / sizeof(*accepted); ++i)
+    BOOST_CHECK_MESSAGE(may_be_addr_spec(accepted[i]), accepted[i]);
+
+  char const * const rejected[] =
+    { "", "a", "@b", " . @b", "a@", "a@ ", "a@.b", "a@(b", "a@@b"
+    , "a b", "a\x01b@c", "a<b@c", "a)@b", "a\\b@c", "(a@b", "\"a@b", "\"a\\\"@b"
+    };
+  for (size_t i = 0; i != sizeof(rejected) / sizeof(*rejected); ++i)
+  {
+    string result;
+    BOOST_CHECK_MESSAGE(!may_be_addr_spec(rejected[i]), rejected[i]);
+    BOOST_CHECK(!parse_addr_spec(result, rejected[i]));
+  }
+}
+
+struct collect_mailboxes
+{
+  string * result;
+  explicit collect_mailboxes(string & r) : result(&r) { }
+  void operator() (mailbox_view<> const & m) const
+  {
+    if (!m.group.empty())
+      *result += string(m.group.begin(), m.group.end()) + ": ";
+    *result += m.canonic_addr_spec() + ';';
+  }
+};
+
+struct count_mailboxes
+{
+  size_t * n;
+  explicit count_mailboxes(size_t & i) : n(&i) { }
+  void operator() (mailbox_view<> const &) const { ++*n; }
+};
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_address_list )
+{
+  string result;
+  spirit::parse_info<> r;
+
+  r = parse( "a@b, \"Doe, John\" <j.doe@example.org> (at work, mostly),\r\n"
+             " Friends: x@y, (a, b) Z <z@w>;, undisclosed-recipients:;, ,last@one,"
+           , address_list_p(collect_mailboxes(result)) >> spirit::end_p
+           , skipper_p
+           );
+  BOOST_REQUIRE(r.full);
+  BOOST_REQUIRE_EQUAL(result, "a@b;j.doe@example.org;Friends: x@y;Friends: z@w;last@one;");
+
+  // Groups aren't mailboxes.
+
+  result.clear();
+  r = parse("a@b, Friends: x@y;", mailbox_list_p(collect_mailboxes(result)), skipper_p);
+  BOOST_REQUIRE(r.hit && !r.full);
+  BOOST_REQUIRE_EQUAL(result, "a@b;");
+
+  // Members of a group that doesn't end aren't reported.
+
+  char const * const unterminated = "a@b, Friends: x@y, z@w";
+  result.clear();
+  r = parse(unterminated, address_list_p(collect_mailboxes(result)), skipper_p);
+  BOOST_REQUIRE(r.stop == unterminated + 4);
+  BOOST_REQUIRE_EQUAL(result, "a@b;");
+
+  result.clear();
+  BOOST_REQUIRE(!parse(",", address_list_p(collect_mailboxes(result)), skipper_p).hit);
+  BOOST_REQUIRE(!parse("Friends:;", mailbox_list_p(collect_mailboxes(result)), skipper_p).hit);
+  BOOST_REQUIRE(result.empty());
+
+  // Long lists take one pass and no memory.
+
+  string input;
+  for (size_t i = 0; i != 10000u; ++i)
+    input += i % 2 ? "\"User, No. 1\" <user1@example.org>,\r\n " : "user2@example.org (User 2), ";
+  input += "Group: a@b, c@d;";
+  char const * const first = input.data();
+  char const * const last  = first + input.size();
+  size_t n( 0u );
+  BOOST_REQUIRE(parse(first, last, address_list_p(count_mailboxes(n)) >> spirit::end_p, skipper_p).full);
+  BOOST_REQUIRE_EQUAL(n, 10002u);
+  n = 0u;
+  size_t const before( allocations );
+  bool const full( parse(first, last, address_list_p(count_mailboxes(n)) >> spirit::end_p, skipper_p).full );
+  size_t const allocated( allocations - before );
+  BOOST_REQUIRE(full);
+  BOOST_REQUIRE_EQUAL(n, 10002u);
+  BOOST_REQUIRE_EQUAL(allocated, 0u);
+}
+
+inline string join_elements(char const * first, char const * last, vector<char const *> const & commas)
+{
+  string result;
+  for (size_t i = 0; i != commas.size(); ++i)
+  {
+    result.append(i ? commas[i - 1u] + 1 : first, commas[i]);
+    result += '|';
+  }
+  return result.append(commas.empty() ? first : commas.back() + 1, last);
+}
+
+inline bool split(string & result, char const * cstr)
+{
+  vector<char const *> commas;
+  bool const ok( split_address_list(cstr, cstr + strlen(cstr), commas) );
+  result = join_elements(cstr, cstr + strlen(cstr), commas);
+  return ok;
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_split_address_list )
+{
+  string result;
+  BOOST_REQUIRE(split(result, "a@b, \"Doe, \\\"John\\\"\" <j@d>, (x, \\) y) z@w,<@r,@s:u@v>, G: m@n, o@p;, a@[1,2] ,"));
+  BOOST_REQUIRE_EQUAL(result, "a@b| \"Doe, \\\"John\\\"\" <j@d>| (x, \\) y) z@w|<@r,@s:u@v>| G: m@n, o@p;| a@[1,2] |");
+  BOOST_REQUIRE(split(result, "a very long display name, which has more than sixteen bytes <a@b>, c@d"));
+  BOOST_REQUIRE_EQUAL(result, "a very long display name| which has more than sixteen bytes <a@b>| c@d");
+  BOOST_REQUIRE(split(result, ""));
+  BOOST_REQUIRE_EQUAL(result, "");
+
+  char const * const unbalanced[] =
+    { "a@b)", "\"a@b", "(a@b", "a@[b", "a@b]", "<a@b", "a@b>", "<<a@b>>"
+    , "a\\@b", "G: a@b", "a@b;", "G: H: a@b;;", "<a@b;>", "a@[b[c]]"
+    };
+  for (size_t i = 0; i != sizeof(unbalanced) / sizeof(unbalanced[0]); ++i)
+    BOOST_REQUIRE_MESSAGE(!split(result, unbalanced[i]), "split: " << unbalanced[i]);
+}
+
+inline bool parse_list(vector<string> & result, string const & input, unsigned threads, size_t min_chunk)
+{
+  address_list_options opt;
+  opt.threads   = threads;
+  opt.min_chunk = min_chunk;
+  return parse_address_list(input.data(), input.data() + input.size(), result, opt);
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_parse_address_list )
+{
+  char const * const elements[] =
+    { "a@b", " \"Doe, John\" <j.doe@example.org>", "\r\n (x, y) z@w", " <@r,@s:u@v>"
+    , " Group: m@n, (c) o@p;", "", " (empty) ", " undisclosed-recipients:;", " q@[1.2.3.4]"
+    };
+  size_t const n_elements( sizeof(elements) / sizeof(elements[0]) );
+
+  // Plain mailboxes come out just like with mailbox_p.
+
+  string input;
+  for (size_t i = 0; i != 1000u; ++i)
+    input += string(i ? "," : "") + elements[i % 4u];
+  vector<string> expected, result;
+  BOOST_REQUIRE(parse(input.c_str(), (mailbox_p[spirit::push_back_a(expected)] % ',') >> spirit::end_p, skipper_p).full);
+  BOOST_REQUIRE(parse_list(result, input, 4u, 1u));
+  BOOST_REQUIRE(result == expected);
+
+  // The split lists come out like the list parsed in one go.
+
+  input.clear();
+  for (size_t i = 0; i != 5000u; ++i)
+    input += string(i ? "," : "") + elements[i % n_elements];
+  expected.assign(1u, "in front");
+  BOOST_REQUIRE(parse_list(expected, input, 1u, 1u));
+  BOOST_REQUIRE_EQUAL(expected.size(), 1u + 5000u / n_elements * 7u + 6u);
+
+  unsigned const threads[] = { 2u, 4u, 0u };
+  size_t const min_chunks[] = { 1u, 1000u, 1u << 20 };
+  for (size_t t = 0; t != sizeof(threads) / sizeof(threads[0]); ++t)
+    for (size_t c = 0; c != sizeof(min_chunks) / sizeof(min_chunks[0]); ++c)
+    {
+      result.assign(1u, "in front");
+      BOOST_REQUIRE(parse_list(result, input, threads[t], min_chunks[c]));
+      BOOST_REQUIRE(result == expected);
+    }
+
+  // So do broken ones, which aren't touched.
+
+  string base;
+  for (size_t i = 0; i != 2u * n_elements; ++i)
+    base += string(i ? "," : "") + elements[i % n_elements];
+  char const noise[] = "\",()\\<>[]:;@ ";
+  for (size_t i = 0; i <= base.size(); ++i)
+    for (size_t j = 0; j <= sizeof(noise) - 1u; ++j)
+    {
+      input = base;
+      if (j == sizeof(noise) - 1u)
+        input.erase(i);
+      else
+        input.insert(i, 1u, noise[j]);
+      expected.assign(1u, "in front");
+      result.assign(1u, "in front");
+      bool const ok( parse_list(expected, input, 1u, 1u) );
+      BOOST_REQUIRE_MESSAGE(parse_list(result, input, 4u, 1u) == ok, "result differs for: " << input);
+      BOOST_REQUIRE_MESSAGE(result == expected, "result differs for: " << input);
+      BOOST_REQUIRE(ok || result.size() == 1u);
+    }
+
+  result.clear();
+  BOOST_REQUIRE(!parse_list(result, ",", 4u, 1u));
+  BOOST_REQUIRE(!parse_list(result, " , (a, b) ,", 4u, 1u));
+  BOOST_REQUIRE(result.empty());
+}
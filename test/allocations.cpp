@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "allocations.hpp"
+#include <cstdlib>
+#include <new>
+
+std::size_t allocations( 0u );
+
+void * operator new(std::size_t n)
+{
+  ++allocations;
+  if (void * const p = std::malloc(n ? n : 1u))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void * p) throw()                  { std::free(p); }
+void operator delete(void * p, std::size_t) throw()     { std::free(p); }
@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#ifndef RFC2822_TEST_ALLOCATIONS_HPP_INCLUDED
+#define RFC2822_TEST_ALLOCATIONS_HPP_INCLUDED
+
+#include <cstddef>
+
+/// The number of calls to operator new. Link test programs that use it
+/// with allocations.cpp, which replaces the global operator new.
+extern std::size_t allocations;
+
+#endif // RFC2822_TEST_ALLOCATIONS_HPP_INCLUDED
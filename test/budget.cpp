@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/address.hpp"
+#include "rfc2822/budget.hpp"
+#include "rfc2822/date.hpp"
+#include "rfc2822/parse.hpp"
+#include "rfc2822/skipper.hpp"
+#include <cstring>
+#include <string>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <boost/test/auto_unit_test.hpp>
+
+using namespace std;
+using namespace rfc2822;
+
+// Parsers that scan a run of characters on their own charge it in one go,
+// so a parse may overshoot its budget by a few characters, or by the
+// length of a fixed-layout date.
+
+static size_t const max_overshoot( 64u );
+
+static string repeat(string const & s, size_t n)
+{
+  string r;
+  r.reserve(s.size() * n);
+  while (n--) r += s;
+  return r;
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_budget_passes_ordinary_input )
+{
+  char const * const inputs[] =
+    { "simple@example.org"
+    , "peter\r\n . \r\n simons @ (Peter (nested)) cryp.to"
+    , "\"quoted \\\" string\" @ [127\r\n  .0\r\n\t.0.1]"
+    };
+  for (size_t i = 0; i != sizeof(inputs) / sizeof(inputs[0]); ++i)
+  {
+    char const * const first = inputs[i];
+    char const * const last  = first + strlen(first);
+    string expected, result;
+    BOOST_REQUIRE(parse(first, last, addr_spec_p [spirit::assign_a(expected)], skipper_p).full);
+    parse_budget budget(1000u, 8u);
+    bounded_parse_info<> const r( bounded_parse(first, last, addr_spec_p [spirit::assign_a(result)], skipper_p, budget) );
+    BOOST_REQUIRE(r.full);
+    BOOST_REQUIRE(!r.exceeded);
+    BOOST_REQUIRE_EQUAL(result, expected);
+    BOOST_REQUIRE(budget.steps >= size_t(last - first));
+  }
+
+  timestamp ts;
+  parse_budget budget(1000u);
+  char const * const date = "Thu, 04 Sep 1973 14:12:17 +0100 (comment)";
+  BOOST_REQUIRE(parse_date(date, date + strlen(date), ts, budget));
+  BOOST_REQUIRE(!budget.exceeded);
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_budget_comment_depth )
+{
+  // Nesting costs no stack, with or without a budget.
+
+  size_t const deep( 1000000u );
+  string const comment( repeat("(", deep) + "x" + repeat(")", deep) );
+  BOOST_REQUIRE(parse(comment.c_str(), comment_p).full);
+  BOOST_REQUIRE(!parse(comment.substr(0u, comment.size() - 1u).c_str(), comment_p).hit);
+
+  string const nested( "(a(b(c)))" );
+  parse_budget enough(parse_budget().max_steps, 3u);
+  BOOST_REQUIRE(bounded_parse(nested.begin(), nested.end(), comment_p, enough).full);
+  parse_budget shallow(parse_budget().max_steps, 2u);
+  bounded_parse_info<string::const_iterator> r( bounded_parse(nested.begin(), nested.end(), comment_p, shallow) );
+  BOOST_REQUIRE(!r.hit);
+  BOOST_REQUIRE(r.exceeded);
+
+  // A comment too deep for the budget fails the whole address, even
+  // though the skipper would otherwise just stop in front of it.
+
+  string const address( "joe@example.org " + repeat("(", 100u) + repeat(")", 100u) );
+  string result;
+  parse_budget budget(parse_budget().max_steps, 64u);
+  BOOST_REQUIRE(!parse_addr_spec(address.data(), address.data() + address.size(), result, budget));
+  BOOST_REQUIRE(budget.exceeded);
+}
+
+// Whether these fail early or run out of budget, they must not spend more
+// than it allows. How parse time grows with the input is checked by the
+// complexity test in fuzz/.
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_budget_hostile_input )
+{
+  string const hostile[] =
+    { repeat("(", 1000000u)
+    , "a" + repeat("\r\n ", 1000000u) + "@"
+    , "a" + repeat(" (x)", 1000000u) + "@"
+    , repeat("a.", 500000u) + "@"
+    , "\"" + repeat("x\r\n ", 500000u) + "@"
+    , repeat("\"x\" ", 500000u) + "<"
+    , "a@[" + repeat("1.\r\n ", 500000u)
+    , repeat("a ", 500000u) + "<a@b"
+    };
+  for (size_t i = 0; i != sizeof(hostile) / sizeof(hostile[0]); ++i)
+  {
+    char const * const first = hostile[i].data();
+    char const * const last  = first + hostile[i].size();
+    string result;
+    {
+      parse_budget budget(10000u, 64u);
+      BOOST_REQUIRE(!parse_addr_spec(first, last, result, budget));
+      BOOST_REQUIRE_LE(budget.steps, budget.max_steps + max_overshoot);
+    }
+    {
+      parse_budget budget(10000u, 64u);
+      BOOST_REQUIRE(!parse_mailbox(first, last, result, budget));
+      BOOST_REQUIRE_LE(budget.steps, budget.max_steps + max_overshoot);
+    }
+  }
+
+  // The comment is too deep; no filter may reject it for free first.
+
+  string const comment( repeat("(", 1000000u) );
+  string result;
+  parse_budget budget(10000u, 64u);
+  BOOST_REQUIRE(!parse_addr_spec(comment.data(), comment.data() + comment.size(), result, budget));
+  BOOST_REQUIRE(budget.exceeded);
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/char-class.hpp"
+#include <string>
+#include <vector>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <boost/test/auto_unit_test.hpp>
+
+using namespace std;
+using namespace rfc2822;
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_char_class_table )
+{
+  using namespace spirit;
+  for (int i = 0; i != 256; ++i)
+  {
+    char const ch( static_cast<char>(i) );
+    char const * const c = &ch;
+    bool const atext( parse(c, c + 1, anychar_p - ( chset_p(" \x7F()<>@,;:\\\".[]") | range_p('\x00','\x1F') )).full );
+    bool const qtext( parse(c, c + 1, anychar_p - ( ch_p('"') | '\\' | cr_p )).full );
+    bool const ctext( parse(c, c + 1, anychar_p - ( chset_p("()\\") | cr_p )).full );
+    bool const wsp( parse(c, c + 1, wsp_p).full );
+    BOOST_CHECK_MESSAGE(bool(char_class_table[i] & atext_class) == atext, "atext mismatch for " << i);
+    BOOST_CHECK_MESSAGE(bool(char_class_table[i] & qtext_class) == qtext, "qtext mismatch for " << i);
+    BOOST_CHECK_MESSAGE(bool(char_class_table[i] & ctext_class) == ctext, "ctext mismatch for " << i);
+    BOOST_CHECK_MESSAGE(bool(char_class_table[i] & wsp_class)   == wsp,   "wsp mismatch for "   << i);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_span_kernels )
+{
+  span_kernels const & scalar = *get_span_kernels(simd_none);
+  simd_level const levels[] = { simd_none, simd_sse2, simd_avx2 };
+
+  // Build a buffer that contains every byte value at least once, with
+  // runs of letters or white space of varying length in between, so that
+  // every kernel hits a stop character at every lane position.
+
+  unsigned long seed( 4711 );
+  vector<char> buf;
+  for (int i = 0; i != 256; ++i)
+  {
+    for (unsigned long n = (seed = seed * 1103515245 + 12345) >> 16 & 63; n; --n)
+      buf.push_back(i % 2 ? " \t"[n % 2] : 'a' + static_cast<char>(n % 26));
+    buf.push_back(static_cast<char>(i));
+  }
+  char const * const first = &buf[0];
+  char const * const last  = first + buf.size();
+
+  for (size_t l = 0; l != sizeof(levels) / sizeof(levels[0]); ++l)
+  {
+    span_kernels const * const k = get_span_kernels(levels[l]);
+    if (!k) continue;
+    for (char const * p = first; p != last; ++p)
+      for (char const * end = p; end != last && end - p <= 80; ++end)
+      {
+        BOOST_REQUIRE_EQUAL(k->atext(p, end), scalar.atext(p, end));
+        BOOST_REQUIRE_EQUAL(k->qtext(p, end), scalar.qtext(p, end));
+        BOOST_REQUIRE_EQUAL(k->ctext(p, end), scalar.ctext(p, end));
+        BOOST_REQUIRE_EQUAL(k->wsp(p, end),   scalar.wsp(p, end));
+      }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_span_parsers )
+{
+  using namespace spirit;
+  string const input( "abc.def\"ghi(jkl)" );
+  char const * const first = input.c_str();
+  char const * const last  = first + input.size();
+
+  // Contiguous buffers and generic iterators must agree.
+  BOOST_REQUIRE_EQUAL(parse(first, last, atext_run_p).length, 3);
+  BOOST_REQUIRE_EQUAL(parse(input.begin(), input.end(), atext_run_p).length, 3);
+  BOOST_REQUIRE_EQUAL(parse(first, last, qtext_run_p).length, 7);
+  BOOST_REQUIRE_EQUAL(parse(input.begin(), input.end(), qtext_run_p).length, 7);
+  BOOST_REQUIRE_EQUAL(parse(first, last, ctext_run_p).length, 11);
+  BOOST_REQUIRE_EQUAL(parse(input.begin(), input.end(), ctext_run_p).length, 11);
+
+  // Empty runs don't match.
+  BOOST_REQUIRE(!parse(".", atext_run_p).hit);
+  BOOST_REQUIRE(!parse("\"", qtext_run_p).hit);
+  BOOST_REQUIRE(!parse(")", ctext_run_p).hit);
+  BOOST_REQUIRE(!parse("", atext_run_p).hit);
+}
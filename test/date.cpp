@@ -11,8 +11,12 @@
  */
 
 #include "rfc2822/date.hpp"
+#include "rfc2822/recognize.hpp"
 #include "rfc2822/skipper.hpp"
 #include <algorithm>
+#include <boost/spirit/include/classic_symbols.hpp>
+#include <cstdio>
+#include <vector>
 
 #define BOOST_AUTO_TEST_MAIN
 #include <boost/test/auto_unit_test.hpp>
@@ -25,6 +29,7 @@ inline char const * parse_date(time_t & result, char const * begin, char const *
   BOOST_REQUIRE(begin <= end);
   timestamp tstamp;
   spirit::parse_info<> const r = parse(begin, end, date_p[spirit::assign_a(tstamp)], skipper_p);
+  BOOST_REQUIRE(recognize_date(begin, end) == (r.hit ? r.stop : NULL));
   if (r.hit)
   {
     result = mktime(&tstamp);
@@ -129,3 +134,152 @@ BOOST_AUTO_TEST_CASE( test_rfc2822_date_parser )
 
   BOOST_REQUIRE_EQUAL(now, new_now);
 }
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_epoch_seconds )
+{
+  // Every four hours and a bit across the range of 32-bit time_t.
+
+  for (boost::int64_t t = -0x7FFFFFFFLL; t < 0x7FFFFFFFLL; t += 14407)
+  {
+    time_t const tt( static_cast<time_t>(t) );
+    timestamp ts;
+    gmtime_r(&tt, &ts);
+    BOOST_REQUIRE_EQUAL(epoch_seconds(ts), t);
+  }
+
+  // Out-of-range days carry over just like with mktime().
+
+  timestamp ts;
+  BOOST_REQUIRE(parse("Thu, 31 Sep 1973 14:12", date_p[spirit::assign_a(ts)], skipper_p).full);
+  BOOST_REQUIRE_EQUAL(epoch_seconds(ts), 118332720);
+
+  // The time zone offset is subtracted to get UTC.
+
+  BOOST_REQUIRE(parse("1 Jan 2000 00:00:00 est", date_p[spirit::assign_a(ts)], skipper_p).full);
+  BOOST_REQUIRE_EQUAL(epoch_seconds(ts), 946702800);
+  BOOST_REQUIRE(parse("Thu, 1 Aug 2002 12:34:55 -1234", date_p[spirit::assign_a(ts)], skipper_p).full);
+  BOOST_REQUIRE_EQUAL(epoch_seconds(ts), 1028250535);
+  BOOST_REQUIRE(parse("29 Feb 2400 23:59:59 +0000", date_p[spirit::assign_a(ts)], skipper_p).full);
+  BOOST_REQUIRE_EQUAL(epoch_seconds(ts), 13574649599LL);
+}
+
+inline void require_same_date(char const * input)
+{
+  static date_parser const reference(false);
+  char const * const end = input + strlen(input);
+  timestamp expected, result;
+  spirit::parse_info<> const r1 = parse(input, end, reference[spirit::assign_a(expected)], skipper_p);
+  spirit::parse_info<> const r2 = parse(input, end, date_p[spirit::assign_a(result)], skipper_p);
+  BOOST_REQUIRE(recognize_date(input, end) == (r2.hit ? r2.stop : NULL));
+  BOOST_REQUIRE_MESSAGE(r1.hit == r2.hit && (!r1.hit || r1.stop == r2.stop), "match differs for: " << input);
+  if (!r1.hit) return;
+  BOOST_REQUIRE_MESSAGE(  expected.tm_wday == result.tm_wday && expected.tm_mday == result.tm_mday
+                       && expected.tm_mon  == result.tm_mon  && expected.tm_year == result.tm_year
+                       && expected.tm_hour == result.tm_hour && expected.tm_min  == result.tm_min
+                       && expected.tm_sec  == result.tm_sec  && expected.tzoffset == result.tzoffset
+                       , "result differs for: " << input
+                       );
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_date_fast_path )
+{
+  for (size_t i = 0; i != sizeof(tests) / sizeof(test_case); ++i)
+    require_same_date(tests[i].input);
+
+  BOOST_REQUIRE(parse("Thu, 04 Sep 1973 14:12:17 +0100", fixed_date_p).full);
+  BOOST_REQUIRE(parse("4 sEP 1973 14:12:17 -0100", fixed_date_p).full);
+  BOOST_REQUIRE(!parse("Thu, 04 Sep 1899 14:12:17 +0100", fixed_date_p).hit);
+
+  // Generate canonical dates plus every single-character corruption and
+  // truncation of them.
+
+  char const * const wdays[]  = { "", "Sun, ", "mon, ", "TUE, ", "Wed, ", "thu, ", "Fri, ", "Sat, ", "Xyz, ", "Sun,  " };
+  char const * const months[] = { "Jan", "feb", "MAR", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec", "Foo" };
+  char const * const years[]  = { "1900", "1899", "1973", "2038", "9999", "0099", "0000" };
+  char const * const zones[]  = { "+0000", "-0000", "+1234", "-0930", "+9999", "GMT", "+12345" };
+  char const   noise[]        = " \t09a:+-,(Z";
+
+  unsigned long seed( 4711 );
+  vector<string> corpus;
+  for (int n = 0; n != 400; ++n)
+  {
+    char buf[128];
+    seed = seed * 1103515245 + 12345;
+    unsigned long const r( seed >> 8 );
+    sprintf( buf, "%s%0*lu %s %s %02lu:%02lu:%02lu %s"
+           , wdays[r % 10], int(r / 7 % 2 + 1), r / 11 % 40, months[r / 3 % 13], years[r / 17 % 7]
+           , r / 5 % 30, r / 13 % 61, r / 19 % 100, zones[r / 23 % 7]
+           );
+    corpus.push_back(buf);
+  }
+
+  for (size_t i = 0; i != corpus.size(); ++i)
+  {
+    string const & base = corpus[i];
+    require_same_date(base.c_str());
+    for (size_t len = 0; len != base.size(); ++len)
+      require_same_date(base.substr(0, len).c_str());
+    for (size_t pos = 0; pos != base.size(); ++pos)
+      for (char const * c = noise; *c; ++c)
+      {
+        string s( base );
+        s[pos] = *c;
+        require_same_date(s.c_str());
+      }
+  }
+}
+
+template <typename ParserT>
+void require_same_keywords(ParserT const & p, spirit::symbols<int> const & reference)
+{
+  // Every string of up to four characters from an alphabet that covers
+  // all keywords in both cases, plus a few bytes that don't occur in any.
+
+  char const alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ \x80";
+  size_t const n( sizeof(alphabet) );   // including the terminating NUL
+  for (size_t i = 0; i != n * n * n * n; ++i)
+  {
+    char buf[4];
+    size_t len( 0 );
+    for (size_t j = i; j && len != 4; j /= n)
+      buf[len++] = alphabet[j % n];
+    char const * const first = buf;
+    char const * const last  = buf + len;
+    int expected( -1 ), result( -1 );
+    spirit::parse_info<> const r1 = parse(first, last, spirit::nocase_d[reference[spirit::assign_a(expected)]]);
+    spirit::parse_info<> const r2 = parse(first, last, spirit::nocase_d[p[spirit::assign_a(result)]]);
+    BOOST_REQUIRE_EQUAL(r1.hit, r2.hit);
+    BOOST_REQUIRE(r1.stop == r2.stop);
+    BOOST_REQUIRE_EQUAL(expected, result);
+    spirit::parse_info<> const r3 = parse(first, last, p);
+    BOOST_REQUIRE(r3.hit == parse(first, last, reference).hit);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_keyword_parsers )
+{
+  spirit::symbols<int> months, wdays, zones;
+  months.add ("jan", 0)("feb", 1)("mar", 2)("apr", 3)
+             ("may", 4)("jun", 5)("jul", 6)("aug", 7)
+             ("sep", 8)("oct", 9)("nov", 10)("dec", 11);
+  wdays.add  ("sun", 0)("mon", 1)("tue", 2)("wed", 3)
+             ("thu", 4)("fri", 5)("sat", 6);
+  zones.add  ("ut", 0)("gmt", 0)
+             ("est", -18000)("edt", -14400)
+             ("cst", -21600)("cdt", -18000)
+             ("mst", -25200)("mdt", -21600)
+             ("pst", -28800)("pdt", -25200);
+  char const military[] = "abcdefghiklmnopqrstuvwxyz";
+  int const offsets[]   = { -1, -2, -3, -4, -5, -6, -7, -8, -9, -10, -11, -12
+                          , +1, +2, +3, +4, +5, +6, +7, +8, +9, +10, +11, +12, 0
+                          };
+  for (size_t i = 0; i != sizeof(offsets) / sizeof(offsets[0]); ++i)
+  {
+    char const name[] = { military[i], '\0' };
+    zones.add(name, offsets[i] * 3600);
+  }
+
+  require_same_keywords(month_p, months);
+  require_same_keywords(wday_p, wdays);
+  require_same_keywords(timezone_p, zones);
+}
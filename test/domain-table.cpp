@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/address-interned.hpp"
+#include "rfc2822/address-view.hpp"
+#include "rfc2822/skipper.hpp"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <boost/test/auto_unit_test.hpp>
+
+using namespace std;
+using namespace rfc2822;
+
+static domain_id intern(domain_table & table, string const & s)
+{
+  return table.intern(s.data(), s.data() + s.size());
+}
+
+static domain_id find(domain_table const & table, string const & s)
+{
+  return table.find(s.data(), s.data() + s.size());
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_domain_table )
+{
+  domain_table table;
+  BOOST_REQUIRE_EQUAL(table.size(), 0u);
+  BOOST_REQUIRE_EQUAL(find(table, "example.org"), domain_table::no_domain);
+
+  domain_id const example( intern(table, "Example.ORG") );
+  BOOST_REQUIRE_EQUAL(example, 1u);
+  BOOST_REQUIRE_EQUAL(intern(table, "example.org"), example);
+  BOOST_REQUIRE_EQUAL(find(table, "EXAMPLE.org"), example);
+  BOOST_REQUIRE_EQUAL(table.name(example), "example.org");
+  BOOST_REQUIRE_EQUAL(intern(table, "cryp.to"), 2u);
+  BOOST_REQUIRE_EQUAL(intern(table, "[127.0.0.1]"), 3u);
+  BOOST_REQUIRE_EQUAL(find(table, "example.or"), domain_table::no_domain);
+  BOOST_REQUIRE_EQUAL(table.size(), 3u);
+
+  // Only ASCII letters are folded.
+
+  BOOST_REQUIRE_EQUAL(intern(table, "\xc4.de"), 4u);
+  BOOST_REQUIRE_EQUAL(find(table, "\xe4.de"), domain_table::no_domain);
+  BOOST_REQUIRE_EQUAL(domain_table::hash(" AbC", " AbC" + 4), domain_table::hash(" abc", " abc" + 4));
+
+  // IDs stay put while the shards grow.
+
+  vector<string> names;
+  for (size_t i = 0; i != 20000u; ++i)
+  {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "host%lu.Example.ORG", static_cast<unsigned long>(i));
+    names.push_back(buf);
+    BOOST_REQUIRE_EQUAL(intern(table, names.back()), domain_id(i + 5u));
+  }
+  for (size_t i = 0; i != names.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(find(table, names[i]), domain_id(i + 5u));
+    BOOST_REQUIRE_EQUAL(table.name(domain_id(i + 5u)).size(), names[i].size());
+  }
+  BOOST_REQUIRE_EQUAL(table.name(example), "example.org");
+  BOOST_REQUIRE_EQUAL(table.size(), names.size() + 4u);
+}
+
+static char const * const domains[] =
+  { "example.org", "Example.ORG", "example\r\n\t.org", "example . org", "example.(x)org", "example.org (x)"
+  , "(x) example.org", "[127\r\n  .0\r\n\t.0.1]", "example.[1.2.3.4]", "a", "a.", "a..b", "a.b.", "a.b>", ".a", "[", ""
+  };
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_interned_domain )
+{
+  domain_table table;
+  for (size_t i = 0; i != sizeof(domains) / sizeof(domains[0]); ++i)
+  {
+    char const * const first = domains[i];
+    char const * const last  = first + strlen(first);
+    string expected;
+    spirit::parse_info<> const r( parse(first, last, domain_p [spirit::assign_a(expected)], skipper_p) );
+    domain_id id( domain_table::no_domain );
+    spirit::parse_info<> const interned( parse(first, last, interned_domain_p(table) [spirit::assign_a(id)], skipper_p) );
+    BOOST_REQUIRE_MESSAGE(interned.hit == r.hit && interned.stop == r.stop, first);
+    if (r.hit)
+      BOOST_REQUIRE_EQUAL(id, find(table, expected));
+  }
+  BOOST_REQUIRE_EQUAL(find(table, "example.org"), 1u);
+  BOOST_REQUIRE_EQUAL(find(table, "[127.0.0.1]"), 2u);
+
+  // Recognizing a domain doesn't enter it.
+
+  size_t const size( table.size() );
+  char const * const fresh[] = { "fresh.example.org", "fresh (x) . org", "[1.2.3.4]", "EXAMPLE.org" };
+  for (size_t i = 0; i != sizeof(fresh) / sizeof(fresh[0]); ++i)
+    BOOST_REQUIRE(parse(fresh[i], spirit::no_actions_d[ interned_domain_p(table) ], skipper_p).full);
+  BOOST_REQUIRE_EQUAL(table.size(), size);
+}
+
+static char const * const addresses[] =
+  { "simons@cryp.to", "Peter.Simons@CRYP.TO", "peter\r\n . \r\n simons @ (Peter) cryp.to"
+  , "\"quoted @ local\"@[127\r\n  .0\r\n\t.0.1]", "a.@b", "a@b.", "a@b@c", "a @b", "a\r\n @b", "@b", "a@", "a"
+  };
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_interned_addr_spec )
+{
+  domain_table table;
+  for (size_t i = 0; i != sizeof(addresses) / sizeof(addresses[0]); ++i)
+  {
+    char const * const first = addresses[i];
+    char const * const last  = first + strlen(first);
+    mailbox_view<> view;
+    spirit::parse_info<> const r( parse(first, last, addr_spec_view_p [spirit::assign_a(view)], skipper_p) );
+    interned_addr_spec result;
+    spirit::parse_info<> const interned( parse(first, last, interned_addr_spec_p(table) [spirit::assign_a(result)], skipper_p) );
+    BOOST_REQUIRE_MESSAGE(interned.hit == r.hit && interned.stop == r.stop, first);
+    if (r.hit)
+    {
+      BOOST_REQUIRE(result.local_part == view.local_part);
+      string const domain( view.canonic_domain() );
+      BOOST_REQUIRE_EQUAL(result.domain, find(table, domain));
+    }
+  }
+  BOOST_REQUIRE_EQUAL(table.size(), 3u);
+  BOOST_REQUIRE_EQUAL(table.name(1u), "cryp.to");
+}
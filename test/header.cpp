@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/header.hpp"
+#include "rfc2822/address.hpp"
+#include "rfc2822/date.hpp"
+#include "rfc2822/skipper.hpp"
+#include <cstring>
+#include <string>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <boost/test/auto_unit_test.hpp>
+
+using namespace std;
+using namespace rfc2822;
+
+static string const message
+  ( "Return-Path: <simons@cryp.to>\r\n"
+    "Received: from example.org (mail.example.org [127.0.0.1])\r\n"
+    "\tby cryp.to (Postfix) with ESMTP id 4711\r\n"
+    "\tfor <simons@cryp.to>; Thu, 4 Sep 1973 14:12:17 +0100\r\n"
+    "Date: Thu,\r\n 4 Sep 1973 (a comment)\r\n  14:12:17 +0100\r\n"
+    "From: Peter Simons\r\n <simons@cryp.to>\r\n"
+    "Subject : bare\nline feed and bare\rcarriage return\r\n"
+    "X-Empty:\r\n"
+    "\r\n"
+    "Body: not a header field\r\n"
+  );
+
+inline string str(header_field::range_type const & r)
+{
+  return string(r.begin(), r.end());
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_split_header )
+{
+  char const * const first = message.data();
+  char const * const last  = first + message.size();
+  vector<header_field> fields;
+  header_info const r( split_header(first, last, fields) );
+  BOOST_REQUIRE_EQUAL(r.status, header_complete);
+  BOOST_REQUIRE_EQUAL(string(r.stop, last), "Body: not a header field\r\n");
+  BOOST_REQUIRE_EQUAL(fields.size(), 6u);
+
+  BOOST_REQUIRE_EQUAL(str(fields[0].name),  "Return-Path");
+  BOOST_REQUIRE_EQUAL(str(fields[0].value), " <simons@cryp.to>");
+  BOOST_REQUIRE_EQUAL(str(fields[1].name),  "Received");
+  BOOST_REQUIRE_EQUAL(str(fields[2].name),  "Date");
+  BOOST_REQUIRE_EQUAL(str(fields[2].value), " Thu,\r\n 4 Sep 1973 (a comment)\r\n  14:12:17 +0100");
+  BOOST_REQUIRE_EQUAL(str(fields[3].name),  "From");
+  BOOST_REQUIRE_EQUAL(str(fields[4].name),  "Subject");
+  BOOST_REQUIRE_EQUAL(str(fields[4].value), " bare\nline feed and bare\rcarriage return");
+  BOOST_REQUIRE_EQUAL(str(fields[5].name),  "X-Empty");
+  BOOST_REQUIRE_EQUAL(str(fields[5].value), "");
+
+  // The value grammars take the raw values as they are.
+  timestamp ts;
+  BOOST_REQUIRE(parse(fields[2].value.begin(), fields[2].value.end(), date_p[spirit::assign_a(ts)], skipper_p).full);
+  BOOST_REQUIRE_EQUAL(ts.tm_mday, 4);
+  BOOST_REQUIRE_EQUAL(ts.tm_hour, 14);
+  string addr;
+  BOOST_REQUIRE(parse(fields[0].value.begin(), fields[0].value.end(), route_addr_p[spirit::assign_a(addr)], skipper_p).full);
+  BOOST_REQUIRE_EQUAL(addr, "<simons@cryp.to>");
+  BOOST_REQUIRE(parse(fields[3].value.begin(), fields[3].value.end(), mailbox_p[spirit::assign_a(addr)], skipper_p).full);
+  BOOST_REQUIRE_EQUAL(addr, "<simons@cryp.to>");
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_split_header_end_of_input )
+{
+  vector<header_field> fields;
+  string const input( "To: a@b.c\r\n\tx\r\nCc: d@e.f" );
+  char const * const first = input.data();
+  char const * const last  = first + input.size();
+
+  header_info r( split_header(first, last, fields) );
+  BOOST_REQUIRE_EQUAL(r.status, header_complete);
+  BOOST_REQUIRE(r.stop == last);
+  BOOST_REQUIRE_EQUAL(fields.size(), 2u);
+  BOOST_REQUIRE_EQUAL(str(fields[1].value), " d@e.f");
+
+  fields.clear();
+  r = split_header(first, last, fields, false);
+  BOOST_REQUIRE_EQUAL(r.status, header_partial);
+  BOOST_REQUIRE_EQUAL(string(r.stop, last), "Cc: d@e.f");
+  BOOST_REQUIRE_EQUAL(fields.size(), 1u);
+
+  fields.clear();
+  r = split_header(first, first, fields);
+  BOOST_REQUIRE_EQUAL(r.status, header_complete);
+  BOOST_REQUIRE(fields.empty());
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_split_header_malformed )
+{
+  char const * const inputs[] =
+    { " folded: without a field\r\n\r\n"
+    , "no colon\r\n\r\n"
+    , ": no name\r\n\r\n"
+    , "\rX: y\r\n\r\n"
+    };
+  for (size_t i = 0; i != sizeof(inputs) / sizeof(inputs[0]); ++i)
+  {
+    vector<header_field> fields;
+    header_info const r( split_header(inputs[i], inputs[i] + strlen(inputs[i]), fields) );
+    BOOST_REQUIRE_EQUAL(r.status, header_malformed);
+    BOOST_REQUIRE(r.stop == inputs[i]);
+  }
+
+  vector<header_field> fields;
+  string const input( "A: b\r\nno colon\r\n\r\n" );
+  header_info const r( split_header(input.data(), input.data() + input.size(), fields) );
+  BOOST_REQUIRE_EQUAL(r.status, header_malformed);
+  BOOST_REQUIRE_EQUAL(string(r.stop), "no colon\r\n\r\n");
+  BOOST_REQUIRE_EQUAL(fields.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_split_header_resume )
+{
+  // Cutting the input anywhere and resuming at stop must give the same
+  // fields as splitting it in one go.
+
+  char const * const first = message.data();
+  char const * const last  = first + message.size();
+  vector<header_field> expected;
+  header_info const reference( split_header(first, last, expected) );
+
+  for (char const * cut = first; cut <= last; ++cut)
+  {
+    vector<header_field> fields;
+    header_info const r1( split_header(first, cut, fields, false) );
+    BOOST_REQUIRE(r1.status != header_malformed);
+    header_info const r2( r1.status == header_partial ? split_header(r1.stop, last, fields) : r1 );
+    BOOST_REQUIRE(r2.stop == reference.stop);
+    BOOST_REQUIRE_EQUAL(fields.size(), expected.size());
+    for (size_t i = 0; i != fields.size(); ++i)
+    {
+      BOOST_REQUIRE(fields[i].name.begin()  == expected[i].name.begin());
+      BOOST_REQUIRE(fields[i].name.end()    == expected[i].name.end());
+      BOOST_REQUIRE(fields[i].value.begin() == expected[i].value.begin());
+      BOOST_REQUIRE(fields[i].value.end()   == expected[i].value.end());
+    }
+  }
+}
+
+// Feed the input in chunks of the given sizes, which are used round-robin,
+// and compare the result to split_header().
+
+inline void require_same_stream(string const & input, size_t const * sizes, size_t n_sizes)
+{
+  char const * const first = input.data();
+  char const * const last  = first + input.size();
+  vector<header_field> expected;
+  header_info const reference( split_header(first, last, expected) );
+
+  header_stream s;
+  vector<header_field> fields;
+  vector<string> names, values;
+  header_status status( header_partial );
+  char const * stop( 0 );
+  for (size_t i = 0, pos = 0; status == header_partial; ++i)
+  {
+    // Copy every chunk, so that nothing can point into the input by chance.
+    string const chunk( first + pos, first + min(input.size(), pos + sizes[i % n_sizes]) );
+    fields.clear();
+    if (chunk.empty())
+      status = s.finish(fields);
+    else
+    {
+      header_info const r( s.feed(chunk.data(), chunk.data() + chunk.size(), fields) );
+      status = r.status;
+      if (status == header_complete)
+        stop = first + pos + (r.stop - chunk.data());
+    }
+    for (size_t j = 0; j != fields.size(); ++j)
+    {
+      names.push_back(str(fields[j].name));
+      values.push_back(str(fields[j].value));
+    }
+    pos += chunk.size();
+  }
+
+  BOOST_REQUIRE_EQUAL(status, reference.status);
+  if (status != header_complete) return;
+  BOOST_REQUIRE(stop == reference.stop || (!stop && reference.stop == last));
+  BOOST_REQUIRE_EQUAL(names.size(), expected.size());
+  for (size_t i = 0; i != expected.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(names[i],  str(expected[i].name));
+    BOOST_REQUIRE_EQUAL(values[i], str(expected[i].value));
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_header_stream )
+{
+  string const inputs[] =
+    { message
+    , "To: a@b.c\r\n\tx\r\nCc: d@e.f"
+    , "To: a@b.c\r\n\tx\r\nCc: d@e.f\r\n"
+    , "To: a\r\r\n\r\n"
+    , "A: b\r\nno colon\r\n\r\n"
+    , " folded: without a field\r\n\r\n"
+    , "A:\r\n"
+    , "A: b\r\n\rX"
+    , "A: b\r\n\r"
+    , "A"
+    , ""
+    };
+
+  for (size_t i = 0; i != sizeof(inputs) / sizeof(inputs[0]); ++i)
+  {
+    for (size_t n = 1; n <= inputs[i].size() + 1; ++n)
+      require_same_stream(inputs[i], &n, 1u);
+    for (size_t cut = 1; cut <= inputs[i].size(); ++cut)
+    {
+      size_t const sizes[] = { cut, inputs[i].size() };
+      require_same_stream(inputs[i], sizes, 2u);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_header_stream_values )
+{
+  // Fields are complete when feed() returns them, no matter how the
+  // value was cut up.
+
+  header_stream s;
+  vector<header_field> fields;
+  char const * const chunks[] = { "Date: Thu,\r", "\n 4 Sep 1973 ", "14:12:17 +0", "100\r", "\n", "From: <simons", "@cryp.to>\r\n\r\nbody" };
+
+  timestamp ts;
+  BOOST_REQUIRE_EQUAL(s.feed(chunks[0], chunks[0] + strlen(chunks[0]), fields).status, header_partial);
+  BOOST_REQUIRE_EQUAL(s.feed(chunks[1], chunks[1] + strlen(chunks[1]), fields).status, header_partial);
+  BOOST_REQUIRE_EQUAL(s.feed(chunks[2], chunks[2] + strlen(chunks[2]), fields).status, header_partial);
+  BOOST_REQUIRE_EQUAL(s.feed(chunks[3], chunks[3] + strlen(chunks[3]), fields).status, header_partial);
+  BOOST_REQUIRE_EQUAL(s.feed(chunks[4], chunks[4] + strlen(chunks[4]), fields).status, header_partial);
+  BOOST_REQUIRE(fields.empty());
+  BOOST_REQUIRE_EQUAL(s.feed(chunks[5], chunks[5] + strlen(chunks[5]), fields).status, header_partial);
+  BOOST_REQUIRE_EQUAL(fields.size(), 1u);
+  BOOST_REQUIRE(parse(fields[0].value.begin(), fields[0].value.end(), date_p[spirit::assign_a(ts)], skipper_p).full);
+  BOOST_REQUIRE_EQUAL(ts.tzoffset, 3600);
+
+  fields.clear();
+  header_info const r( s.feed(chunks[6], chunks[6] + strlen(chunks[6]), fields) );
+  BOOST_REQUIRE_EQUAL(r.status, header_complete);
+  BOOST_REQUIRE_EQUAL(string(r.stop), "body");
+  BOOST_REQUIRE_EQUAL(fields.size(), 1u);
+  string addr;
+  BOOST_REQUIRE(parse(fields[0].value.begin(), fields[0].value.end(), mailbox_p[spirit::assign_a(addr)], skipper_p).full);
+  BOOST_REQUIRE_EQUAL(addr, "<simons@cryp.to>");
+
+  // Further input belongs to the body.
+  BOOST_REQUIRE(s.feed(chunks[0], chunks[0] + 1, fields).stop == chunks[0]);
+
+  s.reset();
+  fields.clear();
+  BOOST_REQUIRE_EQUAL(s.feed(chunks[6], chunks[6] + strlen(chunks[6]), fields).status, header_malformed);
+}
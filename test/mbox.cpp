@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/mbox.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <boost/test/auto_unit_test.hpp>
+
+using namespace std;
+using namespace rfc2822;
+
+static string const mbox
+  ( "From simons@cryp.to Thu Sep  4 14:12:17 1973\n"
+    "Date: Thu, 4 Sep 1973 14:12:17 +0100\n"
+    "From: Peter Simons <simons@cryp.to>\n"
+    "To: a@example.org,\n"
+    " \"B. B.\" <b@example.org>\n"
+    "Cc: c@example.org, List: d@example.org, (e) <e@example.org>;\n"
+    "\n"
+    "The body.\n"
+    ">From is quoted in the body.\n"
+    "\n"
+    "From b@example.org Fri Sep  5 00:00:00 1973\r\n"
+    "Sender: b@example.org\r\n"
+    "Date: 5 Sep 73 00:00 GMT\r\n"
+    "To: broken <\r\n"
+    "\r\n"
+    "From c@example.org Sat Sep  6 00:00:00 1973\n"
+    "Subject: no body, no blank line"
+  );
+
+struct collect
+{
+  vector<mbox_message> * messages;
+  explicit collect(vector<mbox_message> & m) : messages(&m) { }
+  void operator() (mbox_message const & msg) const { messages->push_back(msg); }
+};
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_mbox_messages )
+{
+  vector<mbox_message> m;
+  BOOST_REQUIRE_EQUAL(parse_mbox(mbox.data(), mbox.data() + mbox.size(), collect(m)), 3u);
+  BOOST_REQUIRE_EQUAL(m.size(), 3u);
+
+  BOOST_REQUIRE_EQUAL(m[0].offset, 0u);
+  BOOST_REQUIRE_EQUAL(mbox.compare(m[1].offset, 7, "From b@"), 0);
+  BOOST_REQUIRE_EQUAL(mbox.compare(m[2].offset, 7, "From c@"), 0);
+  BOOST_REQUIRE_EQUAL(m[0].offset + m[0].size, m[1].offset);
+  BOOST_REQUIRE_EQUAL(m[2].offset + m[2].size, mbox.size());
+
+  BOOST_REQUIRE(m[0].has_date);
+  BOOST_REQUIRE_EQUAL(epoch_seconds(m[0].date), 115996337);
+  BOOST_REQUIRE_EQUAL(m[0].from.size(), 1u);
+  BOOST_REQUIRE_EQUAL(m[0].from[0], "simons@cryp.to");
+  BOOST_REQUIRE(m[0].sender.empty());
+  BOOST_REQUIRE_EQUAL(m[0].to.size(), 2u);
+  BOOST_REQUIRE_EQUAL(m[0].to[0], "a@example.org");
+  BOOST_REQUIRE_EQUAL(m[0].to[1], "b@example.org");
+  BOOST_REQUIRE_EQUAL(m[0].cc.size(), 3u);
+  BOOST_REQUIRE_EQUAL(m[0].cc[2], "e@example.org");
+
+  BOOST_REQUIRE(m[1].has_date);
+  BOOST_REQUIRE_EQUAL(m[1].sender, "b@example.org");
+  BOOST_REQUIRE(m[1].to.empty());
+  BOOST_REQUIRE(m[1].from.empty());
+
+  BOOST_REQUIRE(!m[2].has_date);
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_mbox_separators )
+{
+  // Put separators and near misses at every position relative to the
+  // vector width, and compare with a plain search.
+
+  string buf;
+  char const * const lines[] = { "From x\n", "Fro\n", "\nFrom", "From", " From y\n", "F\n" };
+  unsigned long seed( 4711 );
+  for (int i = 0; i != 2000; ++i)
+  {
+    seed = seed * 1103515245u + 12345u;
+    buf += string(seed >> 16 & 31, 'x');
+    buf += lines[(seed >> 8) % (sizeof(lines) / sizeof(lines[0]))];
+  }
+  char const * const first = buf.data();
+  char const * const last  = first + buf.size();
+  for (char const * p = first; p != last; ++p)
+  {
+    char const * expected = p;
+    do
+      ++expected;
+    while (expected != last && !(expected[-1] == '\n' && last - expected >= 5 && memcmp(expected, "From ", 5) == 0));
+    BOOST_REQUIRE(next_mbox_message(p, last) == expected);
+  }
+}
+
+static string generate_mbox(size_t n)
+{
+  string s;
+  char buf[256];
+  for (size_t i = 0; i != n; ++i)
+  {
+    snprintf(buf, sizeof(buf),
+             "From user%lu@example.org Thu Sep  4 14:12:17 1973\n"
+             "Date: %lu Sep 1973 14:%02lu:17 +0100\n"
+             "From: User %lu <user%lu@example.org>\n"
+             "To: a%lu@example.org, b@example.org\n"
+             "\n",
+             (unsigned long)i, (unsigned long)(1 + i % 28), (unsigned long)(i % 60),
+             (unsigned long)i, (unsigned long)i, (unsigned long)i);
+    s += buf;
+    s += string(i % 300, 'x') + "\n";
+  }
+  return s;
+}
+
+inline void require_same_message(mbox_message const & a, mbox_message const & b)
+{
+  BOOST_REQUIRE_EQUAL(a.offset, b.offset);
+  BOOST_REQUIRE_EQUAL(a.size, b.size);
+  BOOST_REQUIRE_EQUAL(a.has_date, b.has_date);
+  BOOST_REQUIRE(!a.has_date || epoch_seconds(a.date) == epoch_seconds(b.date));
+  BOOST_REQUIRE(a.from == b.from);
+  BOOST_REQUIRE(a.sender == b.sender);
+  BOOST_REQUIRE(a.to == b.to);
+  BOOST_REQUIRE(a.cc == b.cc);
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_mbox_order )
+{
+  string const input( generate_mbox(500) );
+  char const * const first = input.data();
+  char const * const last  = first + input.size();
+
+  mbox_options sequential;
+  sequential.threads = 1u;
+  vector<mbox_message> expected;
+  BOOST_REQUIRE_EQUAL(parse_mbox(first, last, collect(expected), sequential), 500u);
+  BOOST_REQUIRE_EQUAL(expected[499].to.size(), 2u);
+
+  unsigned const threads[] = { 2u, 4u, 0u };
+  size_t const batch_sizes[] = { 1u, 1000u, 1u << 20 };
+  for (size_t t = 0; t != sizeof(threads) / sizeof(threads[0]); ++t)
+    for (size_t b = 0; b != sizeof(batch_sizes) / sizeof(batch_sizes[0]); ++b)
+    {
+      mbox_options opt;
+      opt.threads    = threads[t];
+      opt.batch_size = batch_sizes[b];
+      vector<mbox_message> m;
+      BOOST_REQUIRE_EQUAL(parse_mbox(first, last, collect(m), opt), 500u);
+      BOOST_REQUIRE_EQUAL(m.size(), expected.size());
+      for (size_t i = 0; i != m.size(); ++i)
+        require_same_message(m[i], expected[i]);
+    }
+
+  BOOST_REQUIRE_EQUAL(parse_mbox(first, first, collect(expected)), 0u);
+}
+
+struct throw_at
+{
+  size_t * seen;
+  size_t   limit;
+  throw_at(size_t & s, size_t l) : seen(&s), limit(l) { }
+  void operator() (mbox_message const &) const
+  {
+    if (++*seen == limit)
+      throw runtime_error("enough");
+  }
+};
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_mbox_handler_throws )
+{
+  string const input( generate_mbox(500) );
+  mbox_options opt;
+  opt.threads    = 4u;
+  opt.batch_size = 100u;
+  size_t seen( 0u );
+  BOOST_REQUIRE_THROW(parse_mbox(input.data(), input.data() + input.size(), throw_at(seen, 10u), opt), runtime_error);
+  BOOST_REQUIRE_EQUAL(seen, 10u);
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_mapped_file )
+{
+  char path[] = "/tmp/rfc2822-mbox-XXXXXX";
+  int const fd( mkstemp(path) );
+  BOOST_REQUIRE(fd >= 0);
+  BOOST_REQUIRE_EQUAL(write(fd, mbox.data(), mbox.size()), static_cast<ssize_t>(mbox.size()));
+  close(fd);
+  {
+    mapped_file const f(path);
+    BOOST_REQUIRE_EQUAL(string(f.begin(), f.end()), mbox);
+  }
+  BOOST_REQUIRE(truncate(path, 0) == 0);
+  {
+    mapped_file const f(path);
+    BOOST_REQUIRE(f.begin() == f.end());
+  }
+  unlink(path);
+  BOOST_REQUIRE_THROW(mapped_file const missing(path), runtime_error);
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+#include "rfc2822/parse.hpp"
+#include <cstring>
+#include <string>
+
+#ifdef BOOST_SPIRIT_CLASSIC_NS
+#  error "rfc2822/parse.hpp must not depend on Spirit."
+#endif
+
+#define BOOST_AUTO_TEST_MAIN
+#include <boost/test/auto_unit_test.hpp>
+
+using namespace std;
+using namespace rfc2822;
+
+inline char const * end_of(char const * cstr) { return cstr + strlen(cstr); }
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_parse_addr_spec )
+{
+  char const * const input = "peter\r\n . \r\n simons @ (Peter) cryp.to";
+  string result;
+  BOOST_REQUIRE_EQUAL(parse_addr_spec(input, end_of(input), result), end_of(input));
+  BOOST_REQUIRE_EQUAL(result, "peter.simons@cryp.to");
+
+  char const * const partial = "simons@cryp.to, peter@cryp.to";
+  BOOST_REQUIRE_EQUAL(parse_addr_spec(partial, end_of(partial), result), strchr(partial, ','));
+  BOOST_REQUIRE_EQUAL(result, "simons@cryp.to");
+
+  char const * const bad = "no address";
+  BOOST_REQUIRE(!parse_addr_spec(bad, end_of(bad), result));
+  BOOST_REQUIRE_EQUAL(result, "simons@cryp.to");
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_parse_canonic_string )
+{
+  char const * const input = "Peter Simons <simons@cryp.to>";
+  canonic_string result;
+  BOOST_REQUIRE_EQUAL(parse_mailbox(input, end_of(input), result), end_of(input));
+  BOOST_REQUIRE(result.is_slice());
+  BOOST_REQUIRE_EQUAL(result.begin(), strchr(input, '<'));
+  BOOST_REQUIRE_EQUAL(result.str(), "<simons@cryp.to>");
+
+  char const * const messy = "peter\r\n . \r\n simons @ (Peter) cryp.to";
+  BOOST_REQUIRE_EQUAL(parse_addr_spec(messy, end_of(messy), result), end_of(messy));
+  BOOST_REQUIRE(!result.is_slice());
+  BOOST_REQUIRE_EQUAL(result.str(), "peter.simons@cryp.to");
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_parse_mailbox )
+{
+  char const * const input = " Peter Simons < normal . address @ example\r\n\t.org >";
+  string result;
+  BOOST_REQUIRE_EQUAL(parse_mailbox(input, end_of(input), result), end_of(input));
+  BOOST_REQUIRE_EQUAL(result, "<normal.address@example.org>");
+  BOOST_REQUIRE(!parse_mailbox(input, input + 10, result));
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_parse_route_addr )
+{
+  char const * const input = "<@yahoo.org,@hugelwurz.cys.de:\"normal . address \"@ example\r\n\t.org >";
+  string result;
+  BOOST_REQUIRE_EQUAL(parse_route_addr(input, end_of(input), result), end_of(input));
+  BOOST_REQUIRE_EQUAL(result, "<@yahoo.org,@hugelwurz.cys.de:\"normal . address \"@example.org>");
+  BOOST_REQUIRE(!parse_route_addr(input + 1, end_of(input), result));
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_parse_date )
+{
+  char const * const input = "Thu, 04 Sep 1973 14:12:17 +0100";
+  timestamp result;
+  BOOST_REQUIRE_EQUAL(parse_date(input, end_of(input), result), end_of(input));
+  BOOST_REQUIRE_EQUAL(result.tm_year, 73);
+  BOOST_REQUIRE_EQUAL(result.tm_mon, 8);
+  BOOST_REQUIRE_EQUAL(result.tm_mday, 4);
+  BOOST_REQUIRE_EQUAL(result.tzoffset, 3600);
+  BOOST_REQUIRE_EQUAL(epoch_seconds(result), 115996337);
+
+  char const * const bad = "Tho, 4 Sep 1973 14:12";
+  BOOST_REQUIRE(!parse_date(bad, end_of(bad), result));
+  BOOST_REQUIRE_EQUAL(result.tm_mday, 4);
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/address-list.hpp"
+#include "rfc2822/date.hpp"
+#include "rfc2822/recognize.hpp"
+#include "rfc2822/skipper.hpp"
+#include <cstring>
+
+// Building a grammar definition allocates its rules, so a parse that
+// builds one allocates more than the same parse done again.
+
+#include "allocations.hpp"
+
+#define BOOST_AUTO_TEST_MAIN
+#include <boost/test/auto_unit_test.hpp>
+
+using namespace std;
+using namespace rfc2822;
+
+static char const * const inputs[] =
+  { "Joe Q. Public <john.q.public@example.com>"
+  , "Mary Smith <@machine.tld:mary@example.net>"
+  , "Pete(A wonderful \\) chap) <pete(his account)@silly.test(his host)>"
+  , "A Group(Some people):Chris Jones <c@(Chris's host.)public.example>, joe@example.org;"
+  , "jdoe@[192.168.0.1]"
+  , "Fri, 21 Nov 1997 09:55:06 -0600"
+  , "21 Nov 97 09:55:06 GMT"
+  , "Thu,\r\n\t13\r\n\t  Feb\r\n\t    1969\r\n\t23:32\r\n\t\t -0330 (Newfoundland Time)"
+  };
+
+struct ignore_mailbox
+{
+  void operator() (mailbox_view<> const &) const { }
+};
+
+template <typename ParserT>
+void require_prepared(ParserT const & p, char const * name)
+{
+  for (size_t i = 0; i != sizeof(inputs) / sizeof(inputs[0]); ++i)
+  {
+    char const * const first = inputs[i];
+    char const * const last  = first + strlen(first);
+    size_t counts[4];
+    for (size_t j = 0; j != 4u; ++j)
+    {
+      size_t const before( allocations );
+      if (j % 2u)
+        parse(first, last, p);
+      else
+        parse(first, last, p, skipper_p);
+      counts[j] = allocations - before;
+    }
+    BOOST_REQUIRE_MESSAGE(counts[0] == counts[2] && counts[1] == counts[3], name << " isn't prepared for: " << first);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_prepare_parsers )
+{
+  prepare_parsers();
+
+  // Actions don't change the scanner, so these stand for the parsers
+  // with actions as well.
+
+  require_prepared(date_p, "date_p");
+  require_prepared(mailbox_p, "mailbox_p");
+  require_prepared(addr_spec_p, "addr_spec_p");
+  require_prepared(route_addr_p, "route_addr_p");
+  require_prepared(mailbox_view_p, "mailbox_view_p");
+  require_prepared(addr_spec_view_p, "addr_spec_view_p");
+  require_prepared(address_list_p(ignore_mailbox()), "address_list_p");
+  require_prepared(mailbox_list_p(ignore_mailbox()), "mailbox_list_p");
+  require_prepared(spirit::no_actions_d[ mailbox_p ], "no_actions_d[mailbox_p]");
+  require_prepared(spirit::no_actions_d[ date_p ], "no_actions_d[date_p]");
+  require_prepared(word_p, "word_p");
+  require_prepared(comment_p, "comment_p");
+  require_prepared(skipper_p, "skipper_p");
+
+  for (size_t i = 0; i != sizeof(inputs) / sizeof(inputs[0]); ++i)
+  {
+    char const * const first = inputs[i];
+    char const * const last  = first + strlen(first);
+    size_t const before( allocations );
+    recognize_mailbox(first, last);
+    recognize_date(first, last);
+    BOOST_REQUIRE_EQUAL(allocations, before);
+  }
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/address.hpp"
+#include "rfc2822/date.hpp"
+#include "rfc2822/profile.hpp"
+#include "rfc2822/skipper.hpp"
+#include <sstream>
+#include <string>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <boost/test/auto_unit_test.hpp>
+
+#ifndef RFC2822_PROFILE
+#  error "This test needs a profiling build."
+#endif
+
+using namespace std;
+using namespace rfc2822;
+
+struct counts
+{
+  unsigned long long calls, hits, misses, bytes;
+};
+
+// Find a rule in the output of dump_rule_profiles().
+
+inline counts profile_of(char const * rule)
+{
+  ostringstream os;
+  dump_rule_profiles(os);
+  istringstream is(os.str());
+  string line;
+  getline(is, line);            // header
+  while (getline(is, line))
+  {
+    istringstream fields(line);
+    string name;
+    counts c;
+    fields >> name >> c.calls >> c.hits >> c.misses >> c.bytes;
+    BOOST_REQUIRE(fields);
+    BOOST_REQUIRE_EQUAL(c.calls, c.hits + c.misses);
+    if (name == rule)
+      return c;
+  }
+  counts const none = { 0u, 0u, 0u, 0u };
+  return none;
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_profile )
+{
+  std::string result;
+
+  // Build the grammar definitions first, so that all rules are named.
+
+  BOOST_REQUIRE(parse("Peter Simons <simons@cryp.to>", mailbox_p [spirit::assign_a(result)], skipper_p).full);
+  BOOST_REQUIRE(parse("\"quoted\" @ [1.2\r\n .3]", addr_spec_p [spirit::assign_a(result)], skipper_p).full);
+  reset_rule_profiles();
+  BOOST_REQUIRE_EQUAL(profile_of("address:local_part").calls, 0u);
+
+  // The display name is read as a local part first; then phrase_tail
+  // finds that it wasn't one. The address itself takes the fast path.
+
+  BOOST_REQUIRE(parse("Peter Simons <simons@cryp.to>", mailbox_p [spirit::assign_a(result)], skipper_p).full);
+  counts c = profile_of("address:local_part");
+  BOOST_REQUIRE_EQUAL(c.calls, 1u);
+  BOOST_REQUIRE_EQUAL(c.hits, 1u);
+  BOOST_REQUIRE_EQUAL(c.bytes, 5u);             // "Peter"
+  c = profile_of("address:phrase_tail");
+  BOOST_REQUIRE_EQUAL(c.hits, 1u);
+  BOOST_REQUIRE_EQUAL(profile_of("address:route_addr").hits, 1u);
+  BOOST_REQUIRE_EQUAL(profile_of("address:domain").calls, 0u);
+
+  // Rules of the same name share their counters, whichever grammar object
+  // they belong to; the lwsp_p inside a domain literal shows up as well.
+
+  reset_rule_profiles();
+  BOOST_REQUIRE(parse("\"quoted\" @ [1.2\r\n .3]", addr_spec_p [spirit::assign_a(result)], skipper_p).full);
+  BOOST_REQUIRE_EQUAL(result, "\"quoted\"@[1.2.3]");
+  BOOST_REQUIRE_EQUAL(profile_of("address:local_part").hits, 1u);
+  BOOST_REQUIRE_EQUAL(profile_of("address:domain_literal").hits, 1u);
+  BOOST_REQUIRE_EQUAL(profile_of("lwsp:lwsp").hits, 1u);
+  BOOST_REQUIRE(profile_of("address:dtext").hits >= 1u);
+  BOOST_REQUIRE(profile_of("quoted-string:quoted_string").hits >= 1u);
+
+  // A failed parse counts as misses.
+
+  reset_rule_profiles();
+  BOOST_REQUIRE(!parse("no address", addr_spec_p [spirit::assign_a(result)], skipper_p).full);
+  BOOST_REQUIRE_EQUAL(profile_of("address:addr_spec").misses, 1u);
+}
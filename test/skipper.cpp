@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/skipper.hpp"
+#include "rfc2822/address.hpp"
+#include <string>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <boost/test/auto_unit_test.hpp>
+
+using namespace std;
+using namespace rfc2822;
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_skipper )
+{
+  // skipper_p must behave exactly like the obvious grammar on every
+  // string of up to seven characters from an alphabet that exercises
+  // folding, comments, and quoting.
+
+  char const alphabet[] = " \t\r\n()\\a";
+  size_t const n( sizeof(alphabet) - 1 );
+  size_t count( 1 );
+  for (size_t len = 0; len <= 7; ++len, count *= n)
+    for (size_t i = 0; i != count; ++i)
+    {
+      string input;
+      for (size_t j = i, k = 0; k != len; j /= n, ++k)
+        input += alphabet[j % n];
+      char const * const first = input.data();
+      char const * const last  = first + input.size();
+
+      spirit::parse_info<> const r1 = parse(first, last, lwsp_p | comment_p);
+      spirit::parse_info<> const r2 = parse(first, last, skipper_p);
+      BOOST_REQUIRE_EQUAL(r1.hit, r2.hit);
+      BOOST_REQUIRE(r1.stop == r2.stop);
+
+      spirit::parse_info<> const r3 = parse(first, last, *(lwsp_p | comment_p) >> !spirit::ch_p('a'));
+      spirit::parse_info<> const r4 = parse(first, last, *skipper_p >> !spirit::ch_p('a'));
+      BOOST_REQUIRE_EQUAL(r3.hit, r4.hit);
+      BOOST_REQUIRE(r3.stop == r4.stop);
+    }
+
+  // Long runs of white space go through the vectorized kernels.
+
+  string const wide( string(100, ' ') + "\r\n" + string(37, '\t') + "(x)" );
+  BOOST_REQUIRE(parse(wide.c_str(), *skipper_p).full);
+  BOOST_REQUIRE_EQUAL(parse(wide.c_str(), skipper_p).length, 139);
+
+  // Generic iterators take the scalar path.
+
+  BOOST_REQUIRE_EQUAL(parse(wide.begin(), wide.end(), skipper_p).length, 139);
+
+  // Use as a skipper.
+
+  string result;
+  BOOST_REQUIRE(parse("peter\r\n . \r\n simons @ (Peter) cryp.to", addr_spec_p [spirit::assign_a(result)], skipper_p).full);
+  BOOST_REQUIRE_EQUAL(result, "peter.simons@cryp.to");
+}
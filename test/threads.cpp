@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2006-2008 Peter Simons <simons@cryp.to>
+ *
+ * This software is provided 'as-is', without any express or
+ * implied warranty. In no event will the authors be held liable
+ * for any damages arising from the use of this software.
+ *
+ * Copying and distribution of this file, with or without
+ * modification, are permitted in any medium without royalty
+ * provided the copyright notice and this notice are preserved.
+ */
+
+#include "rfc2822/address.hpp"
+#include "rfc2822/address-interned.hpp"
+#include "rfc2822/address-list.hpp"
+#include "rfc2822/address-view.hpp"
+#include "rfc2822/date.hpp"
+#include "rfc2822/header.hpp"
+#include "rfc2822/recognize.hpp"
+#include "rfc2822/skipper.hpp"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <boost/bind/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/thread.hpp>
+#include <dlfcn.h>
+#include <pthread.h>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <boost/test/auto_unit_test.hpp>
+
+#ifndef BOOST_SPIRIT_THREADSAFE
+#  error "This test needs a thread-safe build."
+#endif
+
+using namespace std;
+using namespace rfc2822;
+
+// Count the mutexes every thread locks by wrapping pthread_mutex_lock(),
+// which Boost.Thread uses underneath.
+
+static __thread unsigned long locks_taken;
+
+extern "C" int pthread_mutex_lock(pthread_mutex_t * m)
+{
+  typedef int (*lock_function)(pthread_mutex_t *);
+  static lock_function const next( reinterpret_cast<lock_function>(dlsym(RTLD_NEXT, "pthread_mutex_lock")) );
+  ++locks_taken;
+  return next(m);
+}
+
+static char const * const addresses[] =
+  { "peter\r\n . \r\n simons @ (Peter) cryp.to"
+  , "peter\r\n . \r\n simons @ [127\r\n  .0\r\n\t.0.1]"
+  , " Peter Simons < normal . address @ example\r\n\t.org >"
+  , "Dies \"ist \\\" > ein\" Test <@yahoo.org,@hugelwurz.cys.de:\"normal . address \"@ example\r\n\t.org >"
+  , "a@b, \"Doe, John\" <j.doe@example.org>, Friends: x@y, (a, b) Z <z@w>;"
+  , "no address"
+  };
+
+static char const * const dates[] =
+  { "Thu, 04 Sep 1973 14:12:17 +0100"
+  , "Thu, 4 Sep 1973 14:12"
+  , "1 Jan 2000 00:00:00 est"
+  , "17 Mar 2017 00:00:13 1234"
+  };
+
+static char const header[] =
+  "Date: Thu, 04 Sep 1973 14:12:17 +0100\r\n"
+  "To: a@b,\r\n"
+  " c@d\r\n"
+  "\r\n";
+
+struct append_mailbox
+{
+  string * result;
+  explicit append_mailbox(string & r) : result(&r) { }
+  void operator() (mailbox_view<> const & m) const { *result += m.canonic_addr_spec() + ';'; }
+};
+
+/// Run every parser once and describe what came out.
+static string parse_all()
+{
+  string result;
+  for (size_t i = 0; i != sizeof(addresses) / sizeof(addresses[0]); ++i)
+  {
+    char const * const first = addresses[i];
+    char const * const last  = first + strlen(first);
+    string s;
+    mailbox_view<> view;
+    vector<string> list;
+    result += parse(first, last, addr_spec_p[spirit::assign_a(s)], skipper_p).hit ? s : "-";
+    result += parse(first, last, mailbox_p[spirit::assign_a(s)], skipper_p).hit ? s : "-";
+    result += parse(first, last, route_addr_p[spirit::assign_a(s)], skipper_p).hit ? s : "-";
+    result += parse(first, last, mailbox_view_p[spirit::assign_a(view)], skipper_p).hit ? view.canonic_addr_spec() : "-";
+    result += parse(first, last, address_list_p(append_mailbox(result)), skipper_p).hit ? "+" : "-";
+    result += parse_address_list(first, last, list) ? list.back() : "-";
+    result += recognize_mailbox(first, last) ? "+\n" : "-\n";
+  }
+  for (size_t i = 0; i != sizeof(dates) / sizeof(dates[0]); ++i)
+  {
+    timestamp ts;
+    char buf[32];
+    if (parse(dates[i], date_p[spirit::assign_a(ts)], skipper_p).hit)
+      snprintf(buf, sizeof(buf), "%lld\n", static_cast<long long>(epoch_seconds(ts)));
+    else
+      strcpy(buf, "-\n");
+    result += buf;
+  }
+  vector<header_field> fields;
+  split_header(header, header + sizeof(header) - 1u, fields);
+  for (size_t i = 0; i != fields.size(); ++i)
+    result += string(fields[i].value.begin(), fields[i].value.end());
+  return result;
+}
+
+struct worker_result
+{
+  bool                  same;
+  unsigned long         locks;          ///< After the first round.
+
+  worker_result() : same(true), locks(0u) { }
+};
+
+static void work(string const & expected, boost::barrier & start, worker_result & r)
+{
+  r.same = parse_all() == expected;
+  start.wait();
+  unsigned long const before( locks_taken );
+  for (size_t i = 0; i != 200u; ++i)
+    r.same = parse_all() == expected && r.same;
+  r.locks = locks_taken - before;
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_threads_share_parsers )
+{
+  string const expected( parse_all() );
+  BOOST_REQUIRE(expected.find("j.doe@example.org") != string::npos);
+
+  unsigned const threads( 8u );
+  vector<worker_result> results(threads);
+  boost::barrier start(threads);
+  {
+    boost::thread_group workers;
+    for (unsigned i = 0; i != threads; ++i)
+      workers.create_thread(boost::bind(&work, boost::cref(expected), boost::ref(start), boost::ref(results[i])));
+    workers.join_all();
+  }
+
+  for (unsigned i = 0; i != threads; ++i)
+  {
+    BOOST_REQUIRE(results[i].same);
+    BOOST_REQUIRE_EQUAL(results[i].locks, 0u);
+  }
+}
+
+struct interning_result
+{
+  vector<domain_id>     ids;
+  bool                  listed;         ///< Every ID up to size() had a name while others interned.
+  bool                  found;
+  unsigned long         locks;          ///< For lookups only.
+
+  interning_result() : listed(true), found(true), locks(0u) { }
+};
+
+static void intern_all(domain_table & table, vector<string> const & names, size_t offset, boost::barrier & start, interning_result & r)
+{
+  r.ids.resize(names.size());
+  start.wait();
+  for (size_t n = 0; n != names.size(); ++n)
+  {
+    size_t const i( (n + offset) % names.size() );
+    r.ids[i] = table.intern(names[i].data(), names[i].data() + names[i].size());
+    if (size_t const last = table.size())
+      r.listed = !table.name(domain_id(last)).empty() && r.listed;
+  }
+  start.wait();
+  unsigned long const before( locks_taken );
+  for (size_t i = 0; i != names.size(); ++i)
+  {
+    domain_id id( domain_table::no_domain );
+    char const * const first = names[i].data();
+    r.found = parse(first, first + names[i].size(), interned_domain_p(table) [spirit::assign_a(id)]).full
+           && id == r.ids[i] && r.found;
+  }
+  r.locks = locks_taken - before;
+}
+
+BOOST_AUTO_TEST_CASE( test_rfc2822_threads_share_domain_table )
+{
+  vector<string> names;
+  for (size_t i = 0; i != 5000u; ++i)
+  {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "host%lu.example.org", static_cast<unsigned long>(i));
+    names.push_back(buf);
+  }
+
+  domain_table table;
+  unsigned const threads( 8u );
+  vector<interning_result> results(threads);
+  boost::barrier start(threads);
+  {
+    boost::thread_group workers;
+    for (unsigned i = 0; i != threads; ++i)
+      workers.create_thread(boost::bind( &intern_all, boost::ref(table), boost::cref(names), i * names.size() / threads
+                                       , boost::ref(start), boost::ref(results[i])
+                                       ));
+    workers.join_all();
+  }
+
+  BOOST_REQUIRE_EQUAL(table.size(), names.size());
+  for (unsigned i = 0; i != threads; ++i)
+  {
+    BOOST_REQUIRE(results[i].ids == results[0].ids);
+    BOOST_REQUIRE(results[i].listed);
+    BOOST_REQUIRE(results[i].found);
+    BOOST_REQUIRE_EQUAL(results[i].locks, 0u);
+  }
+  for (size_t i = 0; i != names.size(); ++i)
+    BOOST_REQUIRE_EQUAL(table.name(results[0].ids[i]), names[i]);
+}